@@ -0,0 +1,475 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <buddy/bdd.h>
+
+#include "model/analyzer.h"
+#include "model/comparator.h"
+#include "model/domains.h"
+#include "model/firewall.h"
+#include "model/network.h"
+#include "model/packettester.h"
+#include "ostore/firewallfactory.h"
+#include "ostore/objectstore.h"
+#include "ostore/ostoreconfig.h"
+#include "ostore/policygenerator.h"
+#include "tools/strutil.h"
+#include "fmt/core.h"
+
+
+/*
+ * The bench program measures the time of the main operations of RulesAnalyzer on
+ * generated policies.  A policy is generated for each combination of the requested
+ * sizes and address models.  Results are written in csv or json format, one record
+ * per operation.
+*/
+
+namespace {
+
+	using namespace fwm;
+
+	struct BenchOptions {
+		std::vector<int> sizes{ 1000, 10000, 50000 };
+		std::vector<IPAddressModel> models{ IPAddressModel::IP4Model, IPAddressModel::IP6Model, IPAddressModel::IP64Model };
+		bool json{ false };
+		std::string output_filename;
+		std::string work_dir{ "." };
+		int node_size{ 10000000 };
+		int max_increase{ 4000000 };
+		int min_free_nodes{ 20 };
+		int max_memory{ 0 };
+		int cache_size{ 1000000 };
+		int min_cache_size{ 0 };
+		int max_cache_size{ 0 };
+		VariableOrder variable_order{ VariableOrder::Domain };
+		ReorderMethod reorder_method{ ReorderMethod::None };
+		int page_mode{ BDD_PAGES_DEFAULT };
+		int packets{ 100 };
+	};
+
+
+	struct BenchResult {
+		std::string model;
+		int rules;
+		std::string operation;
+		int count;
+		double seconds;
+	};
+
+
+	// A simple deterministic pseudo random generator.
+	class Random {
+	public:
+		explicit Random(unsigned int seed) : _seed{ seed } {}
+
+		unsigned int next(unsigned int n) {
+			_seed = _seed * 1103515245 + 12345;
+			return (_seed >> 8) % n;
+		}
+
+	private:
+		unsigned int _seed;
+	};
+
+
+	bool no_interrupt()
+	{
+		return false;
+	}
+
+
+	std::string model_name(IPAddressModel model)
+	{
+		switch (model) {
+		case IPAddressModel::IP4Model:
+			return "ipv4";
+		case IPAddressModel::IP6Model:
+			return "ipv6";
+		default:
+			return "ipv64";
+		}
+	}
+
+
+	/* Returns a host address of a subnet generated by the policy generator.
+	*/
+	std::string host(IPAddressModel model, int index, int host)
+	{
+		const bool ipv6 = model == IPAddressModel::IP6Model
+			|| (model == IPAddressModel::IP64Model && index % 4 == 3);
+
+		if (ipv6)
+			return fmt::format("2001:db8:{:x}:{:x}::{:x}", index / 256, index % 256, host);
+		else
+			return fmt::format("10.{}.{}.{}", (index / 256) % 256, index % 256, host);
+	}
+
+
+	/* Generates the files of a policy.  The share of IPv6 addresses follows
+	 * the address model.
+	*/
+	fos::PolicyFiles generate_policy(const BenchOptions& options, IPAddressModel model, int rule_count)
+	{
+		fos::PolicyGeneratorConfig config;
+		config.rule_count = rule_count;
+		config.ipv6_ratio = model == IPAddressModel::IP4Model ? 0 : model == IPAddressModel::IP6Model ? 100 : 25;
+
+		fos::PolicyGenerator generator{ config };
+		return generator.generate(fmt::format("{}/bench-{}-{}", options.work_dir, model_name(model), rule_count));
+	}
+
+
+	// A stream buffer that discards all characters.
+	class NullBuffer : public std::streambuf {
+	protected:
+		virtual int overflow(int c) override { return c; }
+	};
+
+
+	/* Measures the time taken by a function.  The progress shown by the
+	 * analyzer on std::cout is discarded.
+	*/
+	double measure(const std::function<void()>& func)
+	{
+		NullBuffer null_buffer;
+		std::streambuf* cout_buffer = std::cout.rdbuf(&null_buffer);
+
+		try {
+			const auto start_time = std::chrono::steady_clock::now();
+			func();
+			const auto end_time = std::chrono::steady_clock::now();
+
+			std::cout.rdbuf(cout_buffer);
+			return std::chrono::duration<double>(end_time - start_time).count();
+		}
+		catch (...) {
+			std::cout.rdbuf(cout_buffer);
+			throw;
+		}
+	}
+
+
+	void run_bench(const BenchOptions& options, IPAddressModel model, int rule_count, std::vector<BenchResult>& results)
+	{
+		const std::string name = model_name(model);
+		auto add_result = [&results, &name, rule_count](const std::string& operation, int count, double seconds) {
+			results.push_back(BenchResult{ name, rule_count, operation, count, seconds });
+			std::cerr << fmt::format("{:<6} {:>6} {:<16} {:>8.3f}s", name, rule_count, operation, seconds) << std::endl;
+		};
+
+		const fos::PolicyFiles files = generate_policy(options, model, rule_count);
+
+		fos::OstoreConfig config;
+		config.model_config.ip_model = model;
+		config.model_config.strict_ip_parser = false;
+		config.fqdn_resolver_config.enable = false;
+		config.fqdn_resolver_config.cache = false;
+
+		fos::ObjectStore ostore{ config };
+		ostore.initialize();
+		Network network{ config.model_config };
+
+		// Object store
+		add_result("ostore_load", 1, measure([&ostore, &files]() {
+			ostore.load_addresses(files.addresses, no_interrupt);
+			ostore.load_address_groups(files.address_groups, no_interrupt);
+			ostore.load_services(files.services, no_interrupt);
+			ostore.load_service_groups(files.service_groups, no_interrupt);
+			ostore.load_apps(files.applications, no_interrupt);
+		}));
+
+		// Firewall loader
+		Firewall* firewall = new Firewall("bench", network);
+		network.add(firewall);
+
+		fos::FirewallFactory factory{ ostore, config.loader_config };
+		add_result("firewall_load", 1, measure([&factory, firewall, &files]() {
+			const fos::LoaderStatus status = factory.load(*firewall, files.rules, no_interrupt);
+			if (status.error_count > 0)
+				throw std::runtime_error(fmt::format("{} rules not loaded", status.error_count));
+		}));
+
+		const RuleList acl = firewall->acl();
+
+		// Predicates, the bdd of the rules are built on first use.
+		add_result("make_bdd", static_cast<int>(acl.size()), measure([&acl]() {
+			for (const Rule* rule : acl)
+				rule->predicate_bdd();
+		}));
+
+		// Apply throughput, the rule bdds are accumulated in the acl order as
+		// in the anomaly check.  The operator caches are emptied first.
+		std::vector<bdd> predicates;
+		for (const Rule* rule : acl)
+			predicates.push_back(rule->predicate_bdd().make_bdd());
+
+		bdd_gbc();
+		add_result("apply", static_cast<int>(2 * predicates.size()), measure([&predicates]() {
+			bdd covered{ bddfalse };
+			for (const bdd& predicate : predicates) {
+				const bdd uncovered{ bdd_apply(predicate, covered, bddop_diff) };
+				covered = bdd_apply(covered, uncovered, bddop_or);
+			}
+		}));
+
+		// Analyzer
+		add_result("check_anomaly", 1, measure([&acl, model]() {
+			const Analyzer analyzer{ acl, model };
+			analyzer.check_anomaly(no_interrupt);
+		}));
+
+		add_result("check_symmetry", 1, measure([&acl, model]() {
+			const Analyzer analyzer{ acl, model };
+			analyzer.check_symmetry(true, no_interrupt);
+		}));
+
+		// Comparator, compare the acl with the same acl without one rule out of ten.
+		const RuleList other_acl = acl.filter([](const Rule& rule) { return rule.id() % 10 != 0; });
+		add_result("compare", 1, measure([&acl, &other_acl]() {
+			PolicyListComparator::compare(acl, other_acl);
+		}));
+
+		// Packet tester
+		Random random{ 2 };
+		const int subnet_count = std::max(8, rule_count / 4);
+		for (int packet = 0; packet < options.packets; packet++) {
+			const std::string name = fmt::format("packet{}", packet);
+			network.register_src_address(name, host(model, random.next(subnet_count), 1 + random.next(200)));
+			network.register_dst_address(name, host(model, random.next(subnet_count), 1 + random.next(200)));
+		}
+
+		const PacketTester packet_tester{ acl };
+		add_result("packet_test", options.packets, measure([&network, &packet_tester, &options]() {
+			for (int packet = 0; packet < options.packets; packet++) {
+				const std::string name = fmt::format("packet{}", packet);
+				const SrcAddressGroup sources{ "", network.get_src_address(name) };
+				const DstAddressGroup destinations{ "", network.get_dst_address(name) };
+				const ServiceGroup services{ "", network.get_service("any") };
+
+				packet_tester.is_packet_allowed(
+					nullptr, sources,
+					nullptr, destinations,
+					services,
+					nullptr, nullptr, nullptr
+				);
+			}
+		}));
+
+		ostore.terminate();
+
+		for (const std::string& filename : files.filenames())
+			std::remove(filename.c_str());
+	}
+
+
+	void write_results(std::ostream& output, const std::vector<BenchResult>& results, bool json)
+	{
+		if (json) {
+			output << "[\n";
+			for (size_t index = 0; index < results.size(); index++) {
+				const BenchResult& result = results[index];
+				output << fmt::format(
+					"  {{ \"model\": \"{}\", \"rules\": {}, \"operation\": \"{}\", \"count\": {}, \"seconds\": {:.6f} }}{}\n",
+					result.model, result.rules, result.operation, result.count, result.seconds,
+					index + 1 < results.size() ? "," : ""
+				);
+			}
+			output << "]\n";
+		}
+		else {
+			output << "model,rules,operation,count,seconds\n";
+			for (const BenchResult& result : results) {
+				output << fmt::format("{},{},{},{},{:.6f}\n",
+					result.model, result.rules, result.operation, result.count, result.seconds);
+			}
+		}
+	}
+
+
+	std::vector<std::string> next_list(int& arg_idx, int ac, char** av, const char* option)
+	{
+		if (++arg_idx >= ac)
+			throw std::runtime_error(fmt::format("option {} requires an argument", option));
+
+		return rat::split(av[arg_idx], ',');
+	}
+
+
+	int next_int(int& arg_idx, int ac, char** av, const char* option)
+	{
+		int value;
+
+		if (++arg_idx >= ac || !rat::str2i(av[arg_idx], value) || value < 0)
+			throw std::runtime_error(fmt::format("option {} requires a number", option));
+
+		return value;
+	}
+
+
+	BenchOptions parse_options(int ac, char** av)
+	{
+		BenchOptions options;
+
+		for (int arg_idx = 1; arg_idx < ac; arg_idx++) {
+			if (std::strcmp(av[arg_idx], "-sizes") == 0) {
+				options.sizes.clear();
+				for (const std::string& size : next_list(arg_idx, ac, av, "-sizes")) {
+					int value;
+					if (!rat::str2i(size, value) || value < 2)
+						throw std::runtime_error(fmt::format("invalid size '{}'", size));
+					options.sizes.push_back(value);
+				}
+			}
+			else if (std::strcmp(av[arg_idx], "-models") == 0) {
+				options.models.clear();
+				for (const std::string& model : next_list(arg_idx, ac, av, "-models")) {
+					if (rat::iequal(model, "ipv4"))
+						options.models.push_back(IPAddressModel::IP4Model);
+					else if (rat::iequal(model, "ipv6"))
+						options.models.push_back(IPAddressModel::IP6Model);
+					else if (rat::iequal(model, "ipv64"))
+						options.models.push_back(IPAddressModel::IP64Model);
+					else
+						throw std::runtime_error(fmt::format("invalid model '{}'", model));
+				}
+			}
+			else if (std::strcmp(av[arg_idx], "-json") == 0) {
+				options.json = true;
+			}
+			else if (std::strcmp(av[arg_idx], "-o") == 0) {
+				if (++arg_idx >= ac)
+					throw std::runtime_error("option -o requires an argument");
+				options.output_filename = av[arg_idx];
+			}
+			else if (std::strcmp(av[arg_idx], "-dir") == 0) {
+				if (++arg_idx >= ac)
+					throw std::runtime_error("option -dir requires an argument");
+				options.work_dir = av[arg_idx];
+			}
+			else if (std::strcmp(av[arg_idx], "-nodes") == 0) {
+				options.node_size = next_int(arg_idx, ac, av, "-nodes");
+			}
+			else if (std::strcmp(av[arg_idx], "-maxincrease") == 0) {
+				options.max_increase = next_int(arg_idx, ac, av, "-maxincrease");
+			}
+			else if (std::strcmp(av[arg_idx], "-minfree") == 0) {
+				options.min_free_nodes = next_int(arg_idx, ac, av, "-minfree");
+			}
+			else if (std::strcmp(av[arg_idx], "-maxmemory") == 0) {
+				options.max_memory = next_int(arg_idx, ac, av, "-maxmemory");
+			}
+			else if (std::strcmp(av[arg_idx], "-cache") == 0) {
+				options.cache_size = next_int(arg_idx, ac, av, "-cache");
+			}
+			else if (std::strcmp(av[arg_idx], "-mincache") == 0) {
+				options.min_cache_size = next_int(arg_idx, ac, av, "-mincache");
+			}
+			else if (std::strcmp(av[arg_idx], "-maxcache") == 0) {
+				options.max_cache_size = next_int(arg_idx, ac, av, "-maxcache");
+			}
+			else if (std::strcmp(av[arg_idx], "-order") == 0) {
+				if (++arg_idx >= ac)
+					throw std::runtime_error("option -order requires an argument");
+
+				if (rat::iequal(av[arg_idx], "domain"))
+					options.variable_order = VariableOrder::Domain;
+				else if (rat::iequal(av[arg_idx], "interleaved"))
+					options.variable_order = VariableOrder::Interleaved;
+				else if (rat::iequal(av[arg_idx], "zones-first"))
+					options.variable_order = VariableOrder::ZonesFirst;
+				else
+					throw std::runtime_error(fmt::format("invalid variable order '{}'", av[arg_idx]));
+			}
+			else if (std::strcmp(av[arg_idx], "-reorder") == 0) {
+				if (++arg_idx >= ac)
+					throw std::runtime_error("option -reorder requires an argument");
+
+				if (rat::iequal(av[arg_idx], "none"))
+					options.reorder_method = ReorderMethod::None;
+				else if (rat::iequal(av[arg_idx], "sift"))
+					options.reorder_method = ReorderMethod::Sift;
+				else if (rat::iequal(av[arg_idx], "win2"))
+					options.reorder_method = ReorderMethod::Win2;
+				else if (rat::iequal(av[arg_idx], "win3"))
+					options.reorder_method = ReorderMethod::Win3;
+				else
+					throw std::runtime_error(fmt::format("invalid reorder method '{}'", av[arg_idx]));
+			}
+			else if (std::strcmp(av[arg_idx], "-pages") == 0) {
+				if (++arg_idx >= ac)
+					throw std::runtime_error("option -pages requires an argument");
+
+				if (rat::iequal(av[arg_idx], "default"))
+					options.page_mode = BDD_PAGES_DEFAULT;
+				else if (rat::iequal(av[arg_idx], "transparent"))
+					options.page_mode = BDD_PAGES_TRANSPARENT;
+				else if (rat::iequal(av[arg_idx], "huge"))
+					options.page_mode = BDD_PAGES_HUGE;
+				else
+					throw std::runtime_error(fmt::format("invalid page mode '{}'", av[arg_idx]));
+			}
+			else if (std::strcmp(av[arg_idx], "-packets") == 0) {
+				options.packets = next_int(arg_idx, ac, av, "-packets");
+			}
+			else {
+				throw std::runtime_error(fmt::format("unrecognized option '{}'", av[arg_idx]));
+			}
+		}
+
+		return options;
+	}
+
+}
+
+
+int main(int ac, char** av)
+{
+	try {
+		const BenchOptions options = parse_options(ac, av);
+
+		fwm::Domains& domains = fwm::Domains::get();
+		bdd_setpagemode(options.page_mode);
+		domains.init_bdd(options.node_size, options.cache_size, options.variable_order, options.reorder_method);
+		domains.set_growth_policy(options.max_increase, options.min_free_nodes, options.max_memory);
+		domains.set_cache_budget(options.min_cache_size, options.max_cache_size);
+		bdd_gbc_hook(nullptr);
+
+		std::vector<BenchResult> results;
+		for (const IPAddressModel model : options.models) {
+			for (const int size : options.sizes)
+				run_bench(options, model, size, results);
+		}
+
+		if (options.output_filename.empty()) {
+			write_results(std::cout, results, options.json);
+		}
+		else {
+			std::ofstream output{ options.output_filename };
+			write_results(output, results, options.json);
+			if (!output.good())
+				throw std::runtime_error(fmt::format("unable to write file '{}'", options.output_filename));
+		}
+
+		return 0;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "error : " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -47,6 +47,19 @@
 #include <stdio.h>
 #include "uint.h"
 
+   /* The state of the package (node table, caches, variables, pairs and
+      handlers) is kept per thread.  Each thread using BDDs has its own
+      independent manager that must be initialized with bdd_init and
+      released with bdd_done.  A BDD must only be used by the thread that
+      created it. */
+#ifndef BDD_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define BDD_THREAD_LOCAL __declspec(thread)
+#else
+#define BDD_THREAD_LOCAL __thread
+#endif
+#endif
+
 /*=== Defined operators for apply calls ================================*/
 
 #define bddop_and       0
@@ -99,6 +112,8 @@ PROTO   {* typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   long gbctime;
+   int peaknodes;
 } bddStat;  *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
   {\tt produced}     & total number of new nodes ever produced \\
@@ -109,9 +124,12 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
                        garbage collection. \\
   {\tt varnum}       & number of defined bdd variables \\
   {\tt cachesize}    & number of entries in the internal caches \\
-  {\tt gbcnum}       & number of garbage collections done until now
+  {\tt gbcnum}       & number of garbage collections done until now \\
+  {\tt gbctime}      & total time used for garbage collections (clock ticks) \\
+  {\tt peaknodes}    & maximum number of nodes in use since the last call
+                       to bdd\_resetpeak
   \end{tabular} *}
-ALSO    {* bdd\_stats *}
+ALSO    {* bdd\_stats, bdd\_resetpeak *}
 */
 typedef struct s_bddStat
 {
@@ -123,6 +141,8 @@ typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   long gbctime;
+   int peaknodes;
 } bddStat;
 
 
@@ -170,6 +190,8 @@ PROTO   {* typedef struct s_bddCacheStat
    size_t opHit;
    size_t opMiss;
    size_t swapCount;
+   size_t applyCalls;
+   size_t iteCalls;
 } bddCacheStat; *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\bf Name}         & {\bf Number of } \\
@@ -180,6 +202,8 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   opHit           & entries found in the operator caches \\
   opMiss          & entries not found in the operator caches \\
   swapCount       & number of variable swaps in reordering \\
+  applyCalls      & number of calls to bdd\_apply \\
+  iteCalls        & number of calls to bdd\_ite \\
   chainAccess     & number of access in cache chains of length 1, 2, ... \\
 \end{tabular} *}
 ALSO    {* bdd\_cachestats *}
@@ -193,6 +217,8 @@ typedef struct s_bddCacheStat
    size_t opHit;
    size_t opMiss;
    size_t swapCount;
+   size_t applyCalls;
+   size_t iteCalls;
    size_t chainAccess[10];
 } bddCacheStat;
 
@@ -239,18 +265,23 @@ extern int      bdd_isrunning(void);
 extern int      bdd_setmaxnodenum(int);
 extern int      bdd_setmaxincrease(int);
 extern int      bdd_setminfreenodes(int);
+extern int      bdd_setmaxmemory(int);
+extern int      bdd_setpagemode(int);
+extern int      bdd_getpagemode(void);
 extern int      bdd_getnodenum(void);
 extern int      bdd_getallocnum(void);
 extern char*    bdd_versionstr(void);
 extern int      bdd_versionnum(void);
 extern void     bdd_stats(bddStat *);
 extern void     bdd_cachestats(bddCacheStat *);
+extern void     bdd_resetpeak(void);
 extern void     bdd_fprintstat(FILE *);
 extern void     bdd_printstat(void);
 extern void     bdd_default_gbchandler(int, bddGbcStat *);
 extern void     bdd_default_errhandler(int);
 extern const char *bdd_errstring(int);
 extern void     bdd_clear_error(void);
+extern int      bdd_errorcond(void);
 #ifndef CPLUSPLUS
 extern BDD      bdd_true(void);
 extern BDD      bdd_false(void);
@@ -278,6 +309,8 @@ extern void     bdd_freepair(bddPair*);
   /* In bddop.c */
 
 extern int      bdd_setcacheratio(int);
+extern int      bdd_setcachebudget(int, int);
+extern int      bdd_getcachesize(void);
 extern BDD      bdd_buildcube(int, int, BDD *);
 extern BDD      bdd_ibuildcube(int, int, int *);
 extern BDD      bdd_not(BDD);
@@ -313,6 +346,9 @@ extern int      bdd_nodecount(BDD);
 extern int      bdd_anodecount(BDD *, int);
 extern int*     bdd_varprofile(BDD);
 extern double   bdd_pathcount(BDD);
+extern int      bdd_relation(BDD, BDD);
+extern int      bdd_subset(BDD, BDD);
+extern int      bdd_disjoint(BDD, BDD);
 
    
 /* In file "bddio.c" */
@@ -341,6 +377,7 @@ extern bddsizehandler bdd_reorder_probe(bddsizehandler);
 extern void     bdd_clrvarblocks(void);
 extern int      bdd_addvarblock(BDD, int);
 extern int      bdd_intaddvarblock(int, int, int);
+extern int      bdd_intinsvarnum(int, int);
 extern void     bdd_varblockall(void);
 extern bddfilehandler bdd_blockfile_hook(bddfilehandler);
 extern int      bdd_autoreorder(int);
@@ -371,6 +408,20 @@ extern const BDD bddtrue;
 #endif /* CPLUSPLUS */
 
 
+/*=== Pages backing the node table and the caches (see bdd_setpagemode) =*/
+
+#define BDD_PAGES_DEFAULT      0   /* memory allocated with malloc */
+#define BDD_PAGES_TRANSPARENT  1   /* transparent huge pages */
+#define BDD_PAGES_HUGE         2   /* explicit huge pages */
+
+
+/*=== Relationship between two BDDs (see bdd_relation) =================*/
+
+#define BDD_REL_ONLY_LEFT    0x1   /* an assignment satisfies l and not r */
+#define BDD_REL_ONLY_RIGHT   0x2   /* an assignment satisfies r and not l */
+#define BDD_REL_BOTH         0x4   /* an assignment satisfies l and r */
+
+
 /*=== Reordering algorithms ============================================*/
 
 #define BDD_REORDER_NONE     0
@@ -421,6 +472,28 @@ extern const BDD bddtrue;
 *************************************************************************/
 #ifdef CPLUSPLUS
 #include <iostream>
+#include <stdexcept>
+
+/*=== Error handling ===================================================*/
+
+   /* Raised when an operation ran out of nodes.  The results computed
+      since the kernel error condition was set never reach a bdd object,
+      the condition is cleared before the exception is raised. */
+class bddnodeerror : public std::runtime_error
+{
+ public:
+   bddnodeerror(int e) : std::runtime_error(bdd_errstring(e)) {}
+};
+
+inline void bdd_checkerror(void)
+{
+   const int e = bdd_errorcond();
+   if (e != 0)
+   {
+      bdd_clear_error();
+      throw bddnodeerror(e);
+   }
+}
 
 /*=== User BDD class ===================================================*/
 
@@ -459,7 +532,7 @@ class bdd
 private:
    BDD root;
 
-   bdd(BDD r) { bdd_addref(root=r); }
+   bdd(BDD r) { bdd_checkerror(); bdd_addref(root=r); }
    bdd operator=(BDD r);
 
    friend int      bdd_init(int, int);
@@ -510,6 +583,9 @@ private:
    friend int      bdd_anodecountpp(const bdd *, int);
    friend int*     bdd_varprofile(const bdd &);
    friend double   bdd_pathcount(const bdd &);
+   friend int      bdd_relation(const bdd &, const bdd &);
+   friend int      bdd_subset(const bdd &, const bdd &);
+   friend int      bdd_disjoint(const bdd &, const bdd &);
    
    friend void     bdd_fprinttable(FILE *, const bdd &);
    friend void     bdd_printtable(const bdd &);
@@ -692,6 +768,15 @@ inline int* bdd_varprofile(const bdd &r)
 inline double bdd_pathcount(const bdd &r)
 { return bdd_pathcount(r.root); }
 
+inline int bdd_relation(const bdd &l, const bdd &r)
+{ return bdd_relation(l.root, r.root); }
+
+inline int bdd_subset(const bdd &l, const bdd &r)
+{ return bdd_subset(l.root, r.root); }
+
+inline int bdd_disjoint(const bdd &l, const bdd &r)
+{ return bdd_disjoint(l.root, r.root); }
+
 
    /* I/O extensions */
 
@@ -811,7 +896,7 @@ class bdd_ioformat
  private:
    bdd_ioformat(void)  { }
    int format;
-   static int curformat;
+   static BDD_THREAD_LOCAL int curformat;
 
    friend std::ostream &operator<<(std::ostream &, const bdd_ioformat &);
    friend std::ostream &operator<<(std::ostream &, const bdd &);
@@ -48,7 +48,7 @@ static int  bdd_loaddata(FILE *);
 static int  loadhash_get(int);
 static void loadhash_add(int, int);
 
-static bddfilehandler filehandler;
+static BDD_THREAD_LOCAL bddfilehandler filehandler;
 
 typedef struct s_LoadHash
 {
@@ -58,10 +58,10 @@ typedef struct s_LoadHash
    int next;
 } LoadHash;
 
-static LoadHash *lh_table;
-static int       lh_freepos;
-static int       lh_nodenum;
-static int      *loadvar2level;
+static BDD_THREAD_LOCAL LoadHash *lh_table;
+static BDD_THREAD_LOCAL int       lh_freepos;
+static BDD_THREAD_LOCAL int       lh_nodenum;
+static BDD_THREAD_LOCAL int      *loadvar2level;
 
 /*=== PRINTING ========================================================*/
 
@@ -43,6 +43,7 @@
 
 #include "kernel.h"
 #include "cache.h"
+#include "prime.h"
 
    /* Hash value modifiers to distinguish between entries in misccache */
 #define CACHEID_CONSTRAIN   0x0
@@ -50,6 +51,7 @@
 #define CACHEID_SATCOU      0x2
 #define CACHEID_SATCOULN    0x3
 #define CACHEID_PATHCOU     0x4
+#define CACHEID_RELATION    0x5
 
    /* Hash value modifiers for replace/compose */
 #define CACHEID_REPLACE      0x0
@@ -85,39 +87,48 @@ static int oprres[OPERATOR_NUM][4] =
 
 
    /* Variables needed for the operators */
-static int applyop;                 /* Current operator for apply */
-static int appexop;                 /* Current operator for appex */
-static int appexid;                 /* Current cache id for appex */
-static int quantid;                 /* Current cache id for quantifications */
-static int *quantvarset;            /* Current variable set for quant. */
-static int quantvarsetID;           /* Current id used in quantvarset */
-static int quantlast;               /* Current last variable to be quant. */
-static int replaceid;               /* Current cache id for replace */
-static int *replacepair;            /* Current replace pair */
-static int replacelast;             /* Current last var. level to replace */
-static int composelevel;            /* Current variable used for compose */
-static int miscid;                  /* Current cache id for other results */
-static int *varprofile;             /* Current variable profile */
-static int supportID;               /* Current ID (true value) for support */
-static int supportMin;              /* Min. used level in support calc. */
-static int supportMax;              /* Max. used level in support calc. */
-static int* supportSet;             /* The found support set */
-static BddCache applycache;         /* Cache for apply results */
-static BddCache itecache;           /* Cache for ITE results */
-static BddCache quantcache;         /* Cache for exist/forall results */
-static BddCache appexcache;         /* Cache for appex/appall results */
-static BddCache replacecache;       /* Cache for replace results */
-static BddCache misccache;          /* Cache for other results */
-static int cacheratio;
-static BDD satPolarity;
-static int firstReorder;            /* Used instead of local variable in order
+static BDD_THREAD_LOCAL int applyop;                 /* Current operator for apply */
+static BDD_THREAD_LOCAL int appexop;                 /* Current operator for appex */
+static BDD_THREAD_LOCAL int appexid;                 /* Current cache id for appex */
+static BDD_THREAD_LOCAL int quantid;                 /* Current cache id for quantifications */
+static BDD_THREAD_LOCAL int *quantvarset;            /* Current variable set for quant. */
+static BDD_THREAD_LOCAL int quantvarsetID;           /* Current id used in quantvarset */
+static BDD_THREAD_LOCAL int quantlast;               /* Current last variable to be quant. */
+static BDD_THREAD_LOCAL int replaceid;               /* Current cache id for replace */
+static BDD_THREAD_LOCAL int *replacepair;            /* Current replace pair */
+static BDD_THREAD_LOCAL int replacelast;             /* Current last var. level to replace */
+static BDD_THREAD_LOCAL int composelevel;            /* Current variable used for compose */
+static BDD_THREAD_LOCAL int miscid;                  /* Current cache id for other results */
+static BDD_THREAD_LOCAL int *varprofile;             /* Current variable profile */
+static BDD_THREAD_LOCAL int supportID;               /* Current ID (true value) for support */
+static BDD_THREAD_LOCAL int supportMin;              /* Min. used level in support calc. */
+static BDD_THREAD_LOCAL int supportMax;              /* Max. used level in support calc. */
+static BDD_THREAD_LOCAL int* supportSet;             /* The found support set */
+static BDD_THREAD_LOCAL BddCache applycache;         /* Cache for apply results */
+static BDD_THREAD_LOCAL BddCache itecache;           /* Cache for ITE results */
+static BDD_THREAD_LOCAL BddCache quantcache;         /* Cache for exist/forall results */
+static BDD_THREAD_LOCAL BddCache appexcache;         /* Cache for appex/appall results */
+static BDD_THREAD_LOCAL BddCache replacecache;       /* Cache for replace results */
+static BDD_THREAD_LOCAL BddCache misccache;          /* Cache for other results */
+static BDD_THREAD_LOCAL int cacheratio;
+static BDD_THREAD_LOCAL int cachemin;                /* Budget of the adaptive caches, */
+static BDD_THREAD_LOCAL int cachemax;                /* no adaptation when cachemax is 0 */
+static BDD_THREAD_LOCAL size_t samplelookups;        /* Cache lookups at the sample start */
+static BDD_THREAD_LOCAL size_t samplemisses;         /* Cache misses at the sample start */
+static BDD_THREAD_LOCAL int samplewarmup;            /* The caches are filling after a resize */
+static BDD_THREAD_LOCAL int samplegrowfrom;          /* Size before the last growth, 0 if checked */
+static BDD_THREAD_LOCAL double samplegrowhit;        /* Hit rate before the last growth */
+static BDD_THREAD_LOCAL int cachegrowmax;            /* Size above which the caches do not grow */
+static BDD_THREAD_LOCAL BDD satPolarity;
+static BDD_THREAD_LOCAL int relationmask;            /* Relations searched by relation_rec */
+static BDD_THREAD_LOCAL int firstReorder;            /* Used instead of local variable in order
 				       to avoid compiler warning about 'first'
 				       being clobbered by setjmp */
 
-static char*            allsatProfile; /* Variable profile for bdd_allsat() */
-static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
+static BDD_THREAD_LOCAL char* allsatProfile;           /* Variable profile for bdd_allsat() */
+static BDD_THREAD_LOCAL bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
 
-extern bddCacheStat bddcachestats;
+extern BDD_THREAD_LOCAL bddCacheStat bddcachestats;
 
    /* Internal prototypes */
 static BDD    not_rec(BDD);
@@ -141,6 +152,7 @@ static double satcount_rec(int);
 static double satcountln_rec(int);
 static void   varprofile_rec(int);
 static double bdd_pathcount_rec(BDD);
+static int    relation_rec(BDD, BDD);
 static int    varset2vartable(BDD);
 static int    varset2svartable(BDD);
 
@@ -157,6 +169,7 @@ static int    varset2svartable(BDD);
 #define COMPOSEHASH(f,g)     (PAIR(f,g))
 #define SATCOUHASH(r)        (r)
 #define PATHCOUHASH(r)       (r)
+#define RELATIONHASH(l,r)    (PAIR(l,r))
 #define APPEXHASH(l,r,op)    (PAIR(l,r))
 
 #ifndef M_LN2
@@ -195,6 +208,8 @@ int bdd_operator_init(int cachesize)
    quantvarsetID = 0;
    quantvarset = NULL;
    cacheratio = 0;
+   cachemin = 0;
+   cachemax = 0;
    supportSet = NULL;
    
    return 0;
@@ -242,19 +257,96 @@ void bdd_operator_varresize(void)
 }
 
 
+static void bdd_operator_cacheresize(int newcachesize)
+{
+   BddCache_resize(&applycache, newcachesize);
+   BddCache_resize(&itecache, newcachesize);
+   BddCache_resize(&quantcache, newcachesize);
+   BddCache_resize(&appexcache, newcachesize);
+   BddCache_resize(&replacecache, newcachesize);
+   BddCache_resize(&misccache, newcachesize);
+}
+
+
 static void bdd_operator_noderesize(void)
 {
    if (cacheratio > 0)
+      bdd_operator_cacheresize(bddnodesize / cacheratio);
+}
+
+
+   /* A sample lasts CACHESAMPLE lookups per cache entry, the sample following
+      a resize only fills the caches.  The caches grow when the results
+      computed during a sample do not fit and at least CACHEMINHIT of the
+      lookups are hits, a lower hit rate shows that the results are seldom
+      reused.  They shrink when the results fit in an eighth of the entries.
+      The first sample after a growth must raise the hit rate by CACHEMINGAIN,
+      otherwise the caches are restored to their previous size and do not
+      grow beyond it anymore. */
+#define CACHESAMPLE 4
+#define CACHEMINHIT 0.30
+#define CACHEMINGAIN 0.01
+
+static void bdd_operator_sample(void)
+{
+#ifdef CACHESTATS
+   size_t lookups = bddcachestats.opHit + bddcachestats.opMiss - samplelookups;
+   size_t misses;
+   double hit;
+   int size = applycache.tablesize;
+   int newsize = size;
+
+   if (lookups < (size_t)size * CACHESAMPLE)
+      return;
+
+   misses = bddcachestats.opMiss - samplemisses;
+   samplelookups = bddcachestats.opHit + bddcachestats.opMiss;
+   samplemisses = bddcachestats.opMiss;
+
+   if (samplewarmup)
    {
-      int newcachesize = bddnodesize / cacheratio;
-      
-      BddCache_resize(&applycache, newcachesize);
-      BddCache_resize(&itecache, newcachesize);
-      BddCache_resize(&quantcache, newcachesize);
-      BddCache_resize(&appexcache, newcachesize);
-      BddCache_resize(&replacecache, newcachesize);
-      BddCache_resize(&misccache, newcachesize);
+      samplewarmup = 0;
+      return;
    }
+
+   hit = 1.0 - (double)misses / lookups;
+   if (samplegrowfrom > 0)
+   {
+      int growfrom = samplegrowfrom;
+
+      samplegrowfrom = 0;
+      if (hit < samplegrowhit + CACHEMINGAIN)
+      {
+	 cachegrowmax = growfrom;
+	 bdd_operator_cacheresize(growfrom);
+	 samplewarmup = 1;
+	 return;
+      }
+   }
+
+   if (misses > (size_t)size  &&  hit >= CACHEMINHIT  &&  size < cachegrowmax)
+      newsize = size > cachegrowmax / 2 ? cachegrowmax : size * 2;
+   else if (misses < (size_t)size / 8)
+      newsize = size / 2;
+
+   if (newsize > cachemax)
+      newsize = cachemax;
+   if (newsize < cachemin)
+      newsize = cachemin;
+   newsize = bdd_prime_gte(newsize);
+
+   if (newsize > size)
+   {
+      samplegrowfrom = size;
+      samplegrowhit = hit;
+   }
+
+   if (newsize != size)
+   {
+      bdd_operator_cacheresize(newsize);
+      samplewarmup = 1;
+   }
+#endif
 }
 
 
@@ -288,11 +380,79 @@ int bdd_setcacheratio(int r)
       return old;
    
    cacheratio = r;
+   cachemax = 0;
    bdd_operator_noderesize();
    return old;
 }
 
 
+/*
+NAME    {* bdd\_setcachebudget *}
+SECTION {* kernel *}
+SHORT   {* Enables the adaptive size of the operator caches *}
+PROTO   {* int bdd_setcachebudget(int minsize, int maxsize) *}
+DESCR   {* The hit rate of the operator caches is sampled at the end of the
+           operations and the caches are resized to a number of entries
+	   between {\tt minsize} and {\tt maxsize}.  The caches grow when
+	   the results computed during a sample do not fit and enough
+	   lookups are hits, they shrink when most entries are never
+	   used.  A growth that does not raise the hit rate is undone
+	   and the caches do not grow beyond that size until the budget
+	   is set again.  The caches are cleared when they are resized.  A
+	   {\tt maxsize} of 0 keeps the current size.
+	   The hit rate is only sampled when the package is compiled with
+	   {\tt CACHESTATS}.  Setting a cache ratio disables the adaptive
+	   size. *}
+RETURN  {* Zero on success or a negative number on error. *}
+ALSO    {* bdd\_getcachesize, bdd\_setcacheratio *}
+*/
+int bdd_setcachebudget(int minsize, int maxsize)
+{
+   int size = applycache.tablesize;
+   int newsize = size;
+
+   if (minsize < 0  ||  maxsize < 0  ||  (maxsize > 0  &&  maxsize < minsize))
+      return bdd_error(BDD_RANGE);
+
+   cachemin = minsize;
+   cachemax = maxsize;
+   cachegrowmax = maxsize;
+   samplewarmup = 0;
+   samplegrowfrom = 0;
+   samplelookups = bddcachestats.opHit + bddcachestats.opMiss;
+   samplemisses = bddcachestats.opMiss;
+
+   if (maxsize > 0)
+   {
+      cacheratio = 0;
+      if (newsize > maxsize)
+	 newsize = maxsize;
+      if (newsize < minsize)
+	 newsize = minsize;
+      newsize = bdd_prime_gte(newsize);
+
+      if (newsize != size)
+	 bdd_operator_cacheresize(newsize);
+   }
+
+   return 0;
+}
+
+
+/*
+NAME    {* bdd\_getcachesize *}
+SECTION {* kernel *}
+SHORT   {* Returns the size of the operator caches *}
+PROTO   {* int bdd_getcachesize(void) *}
+DESCR   {* Returns the current number of entries of each operator cache. *}
+ALSO    {* bdd\_setcachebudget, bdd\_setcacheratio *}
+*/
+int bdd_getcachesize(void)
+{
+   return applycache.tablesize;
+}
+
+
 /*************************************************************************
   Operators
 *************************************************************************/
@@ -302,6 +462,9 @@ static void checkresize(void)
    if (bddresized)
       bdd_operator_noderesize();
    bddresized = 0;
+
+   if (cachemax > 0)
+      bdd_operator_sample();
 }
 
 
@@ -511,6 +674,10 @@ BDD bdd_apply(BDD l, BDD r, int op)
       return bddfalse;
    }
 
+#ifdef CACHESTATS
+   bddcachestats.applyCalls++;
+#endif
+
  again:
    if (setjmp(bddexception) == 0)
    {
@@ -607,8 +774,12 @@ static BDD apply_rec(BDD l, BDD r)
       bddcachestats.opMiss++;
 #endif
       
+         /* The high children are fetched while the low branches are
+	    computed */
       if (LEVEL(l) == LEVEL(r))
       {
+	 PREFETCH(HIGH(l));
+	 PREFETCH(HIGH(r));
 	 PUSHREF( apply_rec(LOW(l), LOW(r)) );
 	 PUSHREF( apply_rec(HIGH(l), HIGH(r)) );
 	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
@@ -616,12 +787,14 @@ static BDD apply_rec(BDD l, BDD r)
       else
       if (LEVEL(l) < LEVEL(r))
       {
+	 PREFETCH(HIGH(l));
 	 PUSHREF( apply_rec(LOW(l), r) );
 	 PUSHREF( apply_rec(HIGH(l), r) );
 	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
       }
       else
       {
+	 PREFETCH(HIGH(r));
 	 PUSHREF( apply_rec(l, LOW(r)) );
 	 PUSHREF( apply_rec(l, HIGH(r)) );
 	 res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
@@ -738,6 +911,10 @@ BDD bdd_ite(BDD f, BDD g, BDD h)
    CHECKa(g, bddfalse);
    CHECKa(h, bddfalse);
 
+#ifdef CACHESTATS
+   bddcachestats.iteCalls++;
+#endif
+
  again:
    if (setjmp(bddexception) == 0)
    {
@@ -2057,7 +2234,7 @@ RETURN  {* A BDD variable set. *}
 */
 BDD bdd_support(BDD r)
 {
-   static int  supportSize = 0;
+   static BDD_THREAD_LOCAL int supportSize = 0;
    int n;
    int res=1;
 
@@ -2767,6 +2944,149 @@ static double bdd_pathcount_rec(BDD r)
 }
 
 
+/*=== RELATIONSHIP BETWEEN TWO BDDS =====================================*/
+
+/*
+NAME    {* bdd\_relation *}
+SECTION {* info *}
+SHORT   {* finds the relationship between two BDDs *}
+PROTO   {* int bdd_relation(BDD l, BDD r) *}
+DESCR   {* Finds if there are assignments satisfying {\tt l} and not
+           {\tt r}, {\tt r} and not {\tt l}, and both {\tt l} and {\tt r}.
+	   The BDDs are traversed in a single pass, no nodes are created
+	   and the traversal stops as soon as the three kinds of
+	   assignments have been found. *}
+RETURN  {* A combination of {\tt BDD\_REL\_ONLY\_LEFT},
+           {\tt BDD\_REL\_ONLY\_RIGHT} and {\tt BDD\_REL\_BOTH}. *}
+ALSO    {* bdd\_subset, bdd\_disjoint *}
+*/
+int bdd_relation(BDD l, BDD r)
+{
+   CHECKa(l, 0);
+   CHECKa(r, 0);
+
+   relationmask = BDD_REL_ONLY_LEFT | BDD_REL_ONLY_RIGHT | BDD_REL_BOTH;
+   miscid = (relationmask << 3) | CACHEID_RELATION;
+
+   return relation_rec(l, r) & relationmask;
+}
+
+
+/*
+NAME    {* bdd\_subset *}
+SECTION {* info *}
+SHORT   {* tests if a BDD implies another BDD *}
+PROTO   {* int bdd_subset(BDD l, BDD r) *}
+DESCR   {* Tests if all assignments satisfying {\tt l} also satisfy
+           {\tt r}.  This is the same as testing if
+	   {\tt bdd\_imp(l,r)} is {\tt bddtrue} but no nodes are created
+	   and the traversal stops on the first counterexample. *}
+RETURN  {* 1 if {\tt l} implies {\tt r}, otherwise 0. *}
+ALSO    {* bdd\_relation, bdd\_disjoint *}
+*/
+int bdd_subset(BDD l, BDD r)
+{
+   CHECKa(l, 0);
+   CHECKa(r, 0);
+
+   relationmask = BDD_REL_ONLY_LEFT;
+   miscid = (relationmask << 3) | CACHEID_RELATION;
+
+   return (relation_rec(l, r) & relationmask) == 0;
+}
+
+
+/*
+NAME    {* bdd\_disjoint *}
+SECTION {* info *}
+SHORT   {* tests if two BDDs have no common assignment *}
+PROTO   {* int bdd_disjoint(BDD l, BDD r) *}
+DESCR   {* Tests if no assignment satisfies both {\tt l} and {\tt r}.
+           This is the same as testing if {\tt bdd\_and(l,r)} is
+	   {\tt bddfalse} but no nodes are created and the traversal stops
+	   on the first common assignment. *}
+RETURN  {* 1 if {\tt l} and {\tt r} are disjoint, otherwise 0. *}
+ALSO    {* bdd\_relation, bdd\_subset *}
+*/
+int bdd_disjoint(BDD l, BDD r)
+{
+   CHECKa(l, 0);
+   CHECKa(r, 0);
+
+   relationmask = BDD_REL_BOTH;
+   miscid = (relationmask << 3) | CACHEID_RELATION;
+
+   return (relation_rec(l, r) & relationmask) == 0;
+}
+
+
+static int relation_rec(BDD l, BDD r)
+{
+   BddCacheData *entry;
+   int res;
+
+      /* A non constant node has satisfying and falsifying assignments */
+   if (ISCONST(l)  &&  ISCONST(r))
+      return (ISONE(l) && ISZERO(r) ? BDD_REL_ONLY_LEFT : 0) |
+	     (ISZERO(l) && ISONE(r) ? BDD_REL_ONLY_RIGHT : 0) |
+	     (ISONE(l) && ISONE(r) ? BDD_REL_BOTH : 0);
+   if (l == r)
+      return BDD_REL_BOTH;
+   if (ISZERO(l))
+      return BDD_REL_ONLY_RIGHT;
+   if (ISZERO(r))
+      return BDD_REL_ONLY_LEFT;
+   if (ISONE(l))
+      return BDD_REL_ONLY_LEFT | BDD_REL_BOTH;
+   if (ISONE(r))
+      return BDD_REL_ONLY_RIGHT | BDD_REL_BOTH;
+
+   entry = BddCache_lookup(&misccache, RELATIONHASH(l,r));
+   if (entry->a == l  &&  entry->b == r  &&  entry->c == miscid)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+      /* The high branches are skipped when the searched relations have
+	 been found in the low branches */
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PREFETCH(HIGH(l));
+      PREFETCH(HIGH(r));
+      res = relation_rec(LOW(l), LOW(r));
+      if ((res & relationmask) != relationmask)
+	 res |= relation_rec(HIGH(l), HIGH(r));
+   }
+   else if (LEVEL(l) < LEVEL(r))
+   {
+      PREFETCH(HIGH(l));
+      res = relation_rec(LOW(l), r);
+      if ((res & relationmask) != relationmask)
+	 res |= relation_rec(HIGH(l), r);
+   }
+   else
+   {
+      PREFETCH(HIGH(r));
+      res = relation_rec(l, LOW(r));
+      if ((res & relationmask) != relationmask)
+	 res |= relation_rec(l, HIGH(r));
+   }
+
+   entry->a = l;
+   entry->b = r;
+   entry->c = miscid;
+   entry->r.res = res;
+
+   return res;
+}
+
+
 /*************************************************************************
   Other internal functions
 *************************************************************************/
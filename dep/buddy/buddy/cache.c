@@ -48,7 +48,7 @@ int BddCache_init(BddCache *cache, int size)
 
    size = bdd_prime_gte(size);
    
-   if ((cache->table=NEW(BddCacheData,size)) == NULL)
+   if ((cache->table=(BddCacheData*)bdd_tablealloc(sizeof(BddCacheData)*size)) == NULL)
       return bdd_error(BDD_MEMORY);
    
    for (n=0 ; n<size ; n++)
@@ -61,7 +61,7 @@ int BddCache_init(BddCache *cache, int size)
 
 void BddCache_done(BddCache *cache)
 {
-   free(cache->table);
+   bdd_tablefree(cache->table);
    cache->table = NULL;
    cache->tablesize = 0;
 }
@@ -71,11 +71,11 @@ int BddCache_resize(BddCache *cache, int newsize)
 {
    int n;
 
-   free(cache->table);
+   bdd_tablefree(cache->table);
 
    newsize = bdd_prime_gte(newsize);
    
-   if ((cache->table=NEW(BddCacheData,newsize)) == NULL)
+   if ((cache->table=(BddCacheData*)bdd_tablealloc(sizeof(BddCacheData)*newsize)) == NULL)
       return bdd_error(BDD_MEMORY);
    
    for (n=0 ; n<newsize ; n++)
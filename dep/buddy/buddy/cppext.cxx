@@ -49,7 +49,7 @@ using namespace std;
 #define IOFORMAT_ALL    3
 #define IOFORMAT_FDDSET 4
 
-int bdd_ioformat::curformat = IOFORMAT_SET;
+BDD_THREAD_LOCAL int bdd_ioformat::curformat = IOFORMAT_SET;
 bdd_ioformat bddset(IOFORMAT_SET);
 bdd_ioformat bddtable(IOFORMAT_TABLE);
 bdd_ioformat bdddot(IOFORMAT_DOT);
@@ -66,8 +66,8 @@ static void bdd_printdot_rec(ostream&, int);
 static void fdd_printset_rec(ostream &, int, int *);
 
 
-static bddstrmhandler strmhandler_bdd;
-static bddstrmhandler strmhandler_fdd;
+static BDD_THREAD_LOCAL bddstrmhandler strmhandler_bdd;
+static BDD_THREAD_LOCAL bddstrmhandler strmhandler_fdd;
 
    // Avoid calling C++ version of anodecount
 #undef bdd_anodecount
@@ -159,6 +159,7 @@ bdd bdd::operator=(const bdd &r)
 
 bdd bdd::operator=(int r)
 {
+   bdd_checkerror();
    if (root != r)
    {
       bdd_delref(root);
@@ -61,12 +61,12 @@ typedef struct s_Domain
 static void Domain_allocate(Domain*, uint64_t);
 static void Domain_done(Domain*);
 
-static int    firstbddvar;
-static int    fdvaralloc;         /* Number of allocated domains */
-static int    fdvarnum;           /* Number of defined domains */
-static Domain *domain;            /* Table of domain sizes */
+static BDD_THREAD_LOCAL int    firstbddvar;
+static BDD_THREAD_LOCAL int    fdvaralloc;         /* Number of allocated domains */
+static BDD_THREAD_LOCAL int    fdvarnum;           /* Number of defined domains */
+static BDD_THREAD_LOCAL Domain *domain;            /* Table of domain sizes */
 
-static bddfilehandler filehandler;
+static BDD_THREAD_LOCAL bddfilehandler filehandler;
 
 /*************************************************************************
   Domain definition
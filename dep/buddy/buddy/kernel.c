@@ -39,12 +39,17 @@
 
 *************************************************************************/
 #include "config.h"
+#include <limits.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
 #include <assert.h>
+#if defined(__linux__)
+#include <stdint.h>
+#include <sys/mman.h>
+#endif
 
 #include "kernel.h"
 #include "cache.h"
@@ -82,41 +87,47 @@ const BDD bddfalse=0;                    /* The constant false bdd */
 
 /* Min. number of nodes (%) that has to be left after a garbage collect
    unless a resize should be done. */
-static int minfreenodes=20;
+static BDD_THREAD_LOCAL int minfreenodes=20;
+
+/* Pages requested for the node table and the caches of the manager of
+   the current thread. */
+static BDD_THREAD_LOCAL int pagemode=BDD_PAGES_DEFAULT;
 
 
 /*=== GLOBAL KERNEL VARIABLES ==========================================*/
 
-int          bddrunning;            /* Flag - package initialized */
-int          bdderrorcond;          /* Some error condition */
-int          bddnodesize;           /* Number of allocated nodes */
-int          bddmaxnodesize;        /* Maximum allowed number of nodes */
-int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
-BddNode*     bddnodes;          /* All of the bdd nodes */
-int          bddfreepos;        /* First free node */
-int          bddfreenum;        /* Number of free nodes */
-size_t       bddproduced;       /* Number of new nodes ever produced */
-int          bddvarnum;         /* Number of defined BDD variables */
-int*         bddrefstack;       /* Internal node reference stack */
-int*         bddrefstacktop;    /* Internal node reference stack top */
-int*         bddvar2level;      /* Variable -> level table */
-int*         bddlevel2var;      /* Level -> variable table */
-jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
-int          bddresized;        /* Flag indicating a resize of the nodetable */
-
-bddCacheStat bddcachestats;
+BDD_THREAD_LOCAL int          bddrunning;            /* Flag - package initialized */
+BDD_THREAD_LOCAL int          bdderrorcond;          /* Some error condition */
+BDD_THREAD_LOCAL int          bddnodesize;           /* Number of allocated nodes */
+BDD_THREAD_LOCAL int          bddmaxnodesize;        /* Maximum allowed number of nodes */
+BDD_THREAD_LOCAL int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
+BDD_THREAD_LOCAL BddNode*     bddnodes;          /* All of the bdd nodes */
+BDD_THREAD_LOCAL int*         bddhash;           /* Unique table chain heads */
+BDD_THREAD_LOCAL int          bddfreepos;        /* First free node */
+BDD_THREAD_LOCAL int          bddfreenum;        /* Number of free nodes */
+BDD_THREAD_LOCAL size_t       bddproduced;       /* Number of new nodes ever produced */
+BDD_THREAD_LOCAL int          bddvarnum;         /* Number of defined BDD variables */
+BDD_THREAD_LOCAL int*         bddrefstack;       /* Internal node reference stack */
+BDD_THREAD_LOCAL int*         bddrefstacktop;    /* Internal node reference stack top */
+BDD_THREAD_LOCAL int*         bddvar2level;      /* Variable -> level table */
+BDD_THREAD_LOCAL int*         bddlevel2var;      /* Level -> variable table */
+BDD_THREAD_LOCAL jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
+BDD_THREAD_LOCAL int          bddresized;        /* Flag indicating a resize of the nodetable */
+
+BDD_THREAD_LOCAL bddCacheStat bddcachestats;
 
 
 /*=== PRIVATE KERNEL VARIABLES =========================================*/
 
-static BDD*     bddvarset;             /* Set of defined BDD variables */
-static int      gbcollectnum;          /* Number of garbage collections */
-static int      cachesize;             /* Size of the operator caches */
-static long int gbcclock;              /* Clock ticks used in GBC */
-static int      usednodes_nextreorder; /* When to do reorder next time */
-static bddinthandler  err_handler;     /* Error handler */
-static bddgbchandler  gbc_handler;     /* Garbage collection handler */
-static bdd2inthandler resize_handler;  /* Node-table-resize handler */
+static BDD_THREAD_LOCAL BDD*     bddvarset;             /* Set of defined BDD variables */
+static BDD_THREAD_LOCAL int      gbcollectnum;          /* Number of garbage collections */
+static BDD_THREAD_LOCAL int      cachesize;             /* Size of the operator caches */
+static BDD_THREAD_LOCAL long int gbcclock;              /* Clock ticks used in GBC */
+static BDD_THREAD_LOCAL int peaknodenum;                /* Maximum number of nodes in use */
+static BDD_THREAD_LOCAL int      usednodes_nextreorder; /* When to do reorder next time */
+static BDD_THREAD_LOCAL bddinthandler  err_handler;     /* Error handler */
+static BDD_THREAD_LOCAL bddgbchandler  gbc_handler;     /* Garbage collection handler */
+static BDD_THREAD_LOCAL bdd2inthandler resize_handler;  /* Node-table-resize handler */
 
 
    /* Strings for all error mesages */
@@ -182,8 +193,14 @@ int bdd_init(int initnodesize, int cs)
    
    bddnodesize = bdd_prime_gte(initnodesize);
    
-   if ((bddnodes=(BddNode*)malloc(sizeof(BddNode)*bddnodesize)) == NULL)
+   if ((bddnodes=(BddNode*)bdd_tablealloc(sizeof(BddNode)*bddnodesize)) == NULL)
       return bdd_error(BDD_MEMORY);
+   if ((bddhash=(int*)bdd_tablealloc(sizeof(int)*bddnodesize)) == NULL)
+   {
+      bdd_tablefree(bddnodes);
+      bddnodes = NULL;
+      return bdd_error(BDD_MEMORY);
+   }
 
    bddresized = 0;
    
@@ -191,7 +208,7 @@ int bdd_init(int initnodesize, int cs)
    {
       bddnodes[n].refcou = 0;
       LOW(n) = -1;
-      bddnodes[n].hash = 0;
+      bddhash[n] = 0;
       LEVEL(n) = 0;
       bddnodes[n].next = n+1;
    }
@@ -213,6 +230,7 @@ int bdd_init(int initnodesize, int cs)
    bddvarnum = 0;
    gbcollectnum = 0;
    gbcclock = 0;
+   peaknodenum = 0;
    cachesize = cs;
    usednodes_nextreorder = bddnodesize;
    bddmaxnodeincrease = DEFAULTMAXNODEINC;
@@ -226,6 +244,8 @@ int bdd_init(int initnodesize, int cs)
    bddcachestats.opHit = 0;
    bddcachestats.opMiss = 0;
    bddcachestats.swapCount = 0;
+   bddcachestats.applyCalls = 0;
+   bddcachestats.iteCalls = 0;
    memset(bddcachestats.chainAccess, 0, sizeof(bddcachestats.chainAccess));
  
    bdd_gbc_hook(bdd_default_gbchandler);
@@ -258,13 +278,15 @@ void bdd_done(void)
    bdd_reorder_done();
    bdd_pairs_done();
    
-   free(bddnodes);
+   bdd_tablefree(bddnodes);
+   bdd_tablefree(bddhash);
    free(bddrefstack);
    free(bddvarset);
    free(bddvar2level);
    free(bddlevel2var);
    
    bddnodes = NULL;
+   bddhash = NULL;
    bddrefstack = NULL;
    bddvarset = NULL;
 
@@ -403,6 +425,44 @@ int bdd_extvarnum(int num)
 }
 
 
+/* Renumbers the variables, the variable v takes the index newvar[v].  The
+ * nodes refer to levels and are not changed.
+ */
+int bdd_renumbervars(int *newvar)
+{
+   BDD *varset;
+   int *var2level;
+   int n;
+
+   if ((varset=(BDD*)malloc(sizeof(BDD)*bddvarnum*2)) == NULL)
+      return bdd_error(BDD_MEMORY);
+   if ((var2level=(int*)malloc(sizeof(int)*bddvarnum)) == NULL)
+   {
+      free(varset);
+      return bdd_error(BDD_MEMORY);
+   }
+
+   for (n=0 ; n<bddvarnum ; n++)
+   {
+      varset[newvar[n]*2] = bddvarset[n*2];
+      varset[newvar[n]*2+1] = bddvarset[n*2+1];
+      var2level[newvar[n]] = bddvar2level[n];
+   }
+
+   for (n=0 ; n<bddvarnum ; n++)
+   {
+      bddvarset[n*2] = varset[n*2];
+      bddvarset[n*2+1] = varset[n*2+1];
+      bddvar2level[n] = var2level[n];
+      bddlevel2var[var2level[n]] = n;
+   }
+
+   free(var2level);
+   free(varset);
+   return 0;
+}
+
+
 /*
 NAME  {* bdd\_error\_hook *}
 SECTION {* kernel *}
@@ -460,6 +520,23 @@ void bdd_clear_error(void)
 }
 
 
+/*
+NAME    {* bdd\_errorcond *}
+SECTION {* kernel *}
+SHORT   {* returns the error condition of the kernel *}
+PROTO   {* int bdd_errorcond(void) *}
+DESCR   {* Returns the error condition set when the kernel ran out of nodes.
+           The results of the operations done since the condition was set
+	   are meaningless until {\tt bdd\_clear\_error} is called. *}
+RETURN  {* A negative error code, or 0 when no error condition is set. *}
+ALSO    {* bdd\_clear\_error, bdd\_setmaxnodenum *}
+*/
+int bdd_errorcond(void)
+{
+   return -bdderrorcond;
+}
+
+
 /*
 NAME  {* bdd\_gbc\_hook *}
 SECTION {* kernel *}
@@ -582,6 +659,39 @@ int bdd_setmaxnodenum(int size)
 }
 
 
+/*
+NAME    {* bdd\_setmaxmemory *}
+SECTION {* kernel *}
+SHORT {* set the maximum memory used by the node table *}
+PROTO {* int bdd_setmaxmemory(int megabytes) *}
+DESCR {* Converts a memory ceiling of {\tt megabytes} MB to the number of
+         nodes of the node table and of its hash heads fitting in that
+	 memory and sets it with {\tt bdd\_setmaxnodenum}.  The operator
+	 caches are not accounted.  A value of 0 is interpreted as an
+	 unlimited amount. *}
+RETURN {* The maximum number of nodes on success, otherwise a negative
+          error code. *}
+ALSO   {* bdd\_setmaxnodenum *}
+*/
+int bdd_setmaxmemory(int megabytes)
+{
+   size_t size;
+   int err;
+
+   if (megabytes < 0)
+      return bdd_error(BDD_SIZE);
+
+   size = ((size_t)megabytes << 20) / (sizeof(BddNode) + sizeof(int));
+   if (size > INT_MAX)
+      size = INT_MAX;
+
+   if ((err=bdd_setmaxnodenum((int)size)) < 0)
+      return err;
+
+   return (int)size;
+}
+
+
 /*
 NAME    {* bdd\_setminfreenodes *}
 SECTION {* kernel *}
@@ -612,6 +722,59 @@ int bdd_setminfreenodes(int mf)
 }
 
 
+/*
+NAME    {* bdd\_setpagemode *}
+SECTION {* kernel *}
+SHORT   {* set the pages backing the node table and the caches *}
+PROTO   {* int bdd_setpagemode(int mode) *}
+DESCR   {* Selects how the node table and the operator caches are allocated
+           by the following calls to {\tt bdd\_init}.  With
+	   {\tt BDD\_PAGES\_DEFAULT} the tables are allocated with
+	   {\tt malloc}.  With {\tt BDD\_PAGES\_TRANSPARENT} the tables are
+	   mapped on 2 MB boundaries and the kernel is advised to back them
+	   with transparent huge pages.  With {\tt BDD\_PAGES\_HUGE} the
+	   tables are mapped on explicit huge pages reserved by the system
+	   administrator.  Huge pages reduce the TLB misses on large tables.
+	   When the requested pages are not available the allocation falls
+	   back to transparent huge pages and then to {\tt malloc}.  Huge
+	   pages are only available on Linux and only used for tables of at
+	   least 2 MB.  The mode only applies to the manager of the calling
+	   thread, a thread starts with {\tt BDD\_PAGES\_DEFAULT}. *}
+RETURN  {* The old mode on success, otherwise a negative error code. *}
+ALSO    {* bdd\_getpagemode, bdd\_init *}
+*/
+int bdd_setpagemode(int mode)
+{
+   int old = pagemode;
+
+   if (mode < BDD_PAGES_DEFAULT  ||  mode > BDD_PAGES_HUGE)
+      return bdd_error(BDD_RANGE);
+
+   pagemode = mode;
+   return old;
+}
+
+
+/*
+NAME    {* bdd\_getpagemode *}
+SECTION {* kernel *}
+SHORT   {* get the pages backing the node table *}
+PROTO   {* int bdd_getpagemode(void) *}
+DESCR   {* Returns the kind of pages actually backing the node table, which
+           can differ from the mode requested with {\tt bdd\_setpagemode}
+	   when huge pages are not available.  The requested mode is
+	   returned when the package is not running. *}
+ALSO    {* bdd\_setpagemode *}
+*/
+int bdd_getpagemode(void)
+{
+   if (!bddrunning)
+      return pagemode;
+
+   return bdd_tablepagemode(bddnodes);
+}
+
+
 /*
 NAME    {* bdd\_getnodenum *}
 SECTION {* kernel *}
@@ -711,8 +874,25 @@ void bdd_stats(bddStat *s)
    s->freenodes = bddfreenum;
    s->minfreenodes = minfreenodes;
    s->varnum = bddvarnum;
-   s->cachesize = cachesize;
+   s->cachesize = bdd_getcachesize();
    s->gbcnum = gbcollectnum;
+   s->gbctime = gbcclock;
+   s->peaknodes = MAX(peaknodenum, bddnodesize - bddfreenum);
+}
+
+
+/*
+NAME    {* bdd\_resetpeak *}
+SECTION {* kernel *}
+SHORT   {* Resets the maximum number of nodes in use *}
+PROTO   {* void bdd_resetpeak(void) *}
+DESCR   {* Sets the {\tt peaknodes} field of the status information to
+           the number of nodes currently in use. *}
+ALSO    {* bddStat, bdd\_stats *}
+*/
+void bdd_resetpeak(void)
+{
+   peaknodenum = bddnodesize - bddfreenum;
 }
 
 
@@ -791,6 +971,9 @@ void bdd_fprintstat(FILE *ofile)
    fprintf(ofile, "\n");
    fprintf(ofile, "Swap count =    %zd\n", s.swapCount);
    fprintf(ofile, "\n");
+   fprintf(ofile, "Apply calls:    %zd\n", s.applyCalls);
+   fprintf(ofile, "Ite calls:      %zd\n", s.iteCalls);
+   fprintf(ofile, "\n");
 }
 
 
@@ -1038,8 +1221,8 @@ static void bdd_gbc_rehash(void)
           register unsigned int hash;
 
           hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-          node->next = bddnodes[hash].hash;
-          bddnodes[hash].hash = n;
+          node->next = bddhash[hash];
+          bddhash[hash] = n;
       }
       else
       {
@@ -1057,6 +1240,9 @@ void bdd_gbc(void)
    int n;
    long int c2, c1 = clock();
 
+   if (bddnodesize - bddfreenum > peaknodenum)
+      peaknodenum = bddnodesize - bddfreenum;
+
    if (gbc_handler != NULL)
    {
       bddGbcStat s;
@@ -1075,7 +1261,7 @@ void bdd_gbc(void)
    {
       if (bddnodes[n].refcou > 0)
          bdd_mark(n);
-      bddnodes[n].hash = 0;
+      bddhash[n] = 0;
    }
    
    bddfreepos = 0;
@@ -1091,8 +1277,8 @@ void bdd_gbc(void)
 
           LEVELp(node) &= MARKOFF;
           hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-          node->next = bddnodes[hash].hash;
-          bddnodes[hash].hash = n;
+          node->next = bddhash[hash];
+          bddhash[hash] = n;
       }
       else
       {
@@ -1274,6 +1460,148 @@ void bdd_unmark_upto(int i, int level)
 }
 
 
+/*************************************************************************
+  Allocation of the node table and the caches
+*************************************************************************/
+
+   /* The tables are prefixed with a header telling how they are mapped.
+      The header keeps the tables aligned on cache lines. */
+#define HUGEPAGESIZE ((size_t)2*1024*1024)
+#define TABLEHEADERSIZE 64
+
+typedef struct s_TableHeader
+{
+   size_t size;      /* Size of the table */
+   size_t mapsize;   /* Size of the mapping, 0 if allocated with malloc */
+   int mode;         /* Pages backing the table */
+} TableHeader;
+
+
+#if defined(__linux__)
+static void *table_map(size_t mapsize, int mode, int *used)
+{
+   char *map;
+
+   if (mode == BDD_PAGES_HUGE)
+   {
+      map = (char*)mmap(NULL, mapsize, PROT_READ|PROT_WRITE,
+			MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+      if (map != MAP_FAILED)
+      {
+	 *used = BDD_PAGES_HUGE;
+	 return map;
+      }
+   }
+
+      /* Map one more huge page and trim the mapping on a huge page
+	 boundary, transparent huge pages are only used for aligned
+	 ranges */
+   map = (char*)mmap(NULL, mapsize+HUGEPAGESIZE, PROT_READ|PROT_WRITE,
+		     MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+   if (map == MAP_FAILED)
+      return NULL;
+   else
+   {
+      char *start = (char*)(((uintptr_t)map + HUGEPAGESIZE-1) & ~(uintptr_t)(HUGEPAGESIZE-1));
+      char *end = start + mapsize;
+
+      if (start > map)
+	 munmap(map, start-map);
+      if (map+mapsize+HUGEPAGESIZE > end)
+	 munmap(end, map+mapsize+HUGEPAGESIZE-end);
+
+      *used = madvise(start, mapsize, MADV_HUGEPAGE) == 0 ?
+	 BDD_PAGES_TRANSPARENT : BDD_PAGES_DEFAULT;
+      return start;
+   }
+}
+#endif
+
+
+void *bdd_tablealloc(size_t size)
+{
+   TableHeader *header = NULL;
+   size_t mapsize = 0;
+   int used = BDD_PAGES_DEFAULT;
+
+#if defined(__linux__)
+   if (pagemode != BDD_PAGES_DEFAULT  &&  size+TABLEHEADERSIZE >= HUGEPAGESIZE)
+   {
+      mapsize = (size+TABLEHEADERSIZE+HUGEPAGESIZE-1) & ~(HUGEPAGESIZE-1);
+      header = (TableHeader*)table_map(mapsize, pagemode, &used);
+   }
+#endif
+
+   if (header == NULL)
+   {
+      mapsize = 0;
+      used = BDD_PAGES_DEFAULT;
+      if ((header=(TableHeader*)malloc(size+TABLEHEADERSIZE)) == NULL)
+	 return NULL;
+   }
+
+   header->size = size;
+   header->mapsize = mapsize;
+   header->mode = used;
+
+   return (char*)header + TABLEHEADERSIZE;
+}
+
+
+void *bdd_tablerealloc(void *table, size_t size)
+{
+   TableHeader *header;
+   void *newtable;
+
+   if (table == NULL)
+      return bdd_tablealloc(size);
+
+   header = (TableHeader*)((char*)table - TABLEHEADERSIZE);
+   if (header->mapsize == 0  &&  pagemode == BDD_PAGES_DEFAULT)
+   {
+      if ((header=(TableHeader*)realloc(header, size+TABLEHEADERSIZE)) == NULL)
+	 return NULL;
+      header->size = size;
+      return (char*)header + TABLEHEADERSIZE;
+   }
+
+   if ((newtable=bdd_tablealloc(size)) == NULL)
+      return NULL;
+   memcpy(newtable, table, MIN(size, header->size));
+   bdd_tablefree(table);
+
+   return newtable;
+}
+
+
+void bdd_tablefree(void *table)
+{
+   TableHeader *header;
+
+   if (table == NULL)
+      return;
+
+   header = (TableHeader*)((char*)table - TABLEHEADERSIZE);
+#if defined(__linux__)
+   if (header->mapsize > 0)
+   {
+      munmap(header, header->mapsize);
+      return;
+   }
+#endif
+   free(header);
+}
+
+
+int bdd_tablepagemode(void *table)
+{
+   if (table == NULL)
+      return BDD_PAGES_DEFAULT;
+
+   return ((TableHeader*)((char*)table - TABLEHEADERSIZE))->mode;
+}
+
+
 /*************************************************************************
   Unique node table functions
 *************************************************************************/
@@ -1295,7 +1623,7 @@ int bdd_makenode(unsigned int level, int low, int high)
 
       /* Try to find an existing node of this kind */
    hash = NODEHASH(level, low, high);
-   res = bddnodes[hash].hash;
+   res = bddhash[hash];
 
    while(res != 0)
    {
@@ -1365,8 +1693,8 @@ int bdd_makenode(unsigned int level, int low, int high)
    HIGHp(node) = high;
    
       /* Insert node */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+   node->next = bddhash[hash];
+   bddhash[hash] = res;
 
    return res;
 }
@@ -1375,6 +1703,7 @@ int bdd_makenode(unsigned int level, int low, int high)
 int bdd_noderesize(int doRehash)
 {
    BddNode *newnodes;
+   int *newhash;
    int oldsize = bddnodesize;
    int n;
 
@@ -1394,19 +1723,31 @@ int bdd_noderesize(int doRehash)
    if (resize_handler != NULL)
       resize_handler(oldsize, bddnodesize);
 
-   newnodes = (BddNode*)realloc(bddnodes, sizeof(BddNode)*bddnodesize);
+      /* Keep the old size on failure, the tables are still valid */
+   newnodes = (BddNode*)bdd_tablerealloc(bddnodes, sizeof(BddNode)*bddnodesize);
    if (newnodes == NULL)
+   {
+      bddnodesize = oldsize;
       return bdd_error(BDD_MEMORY);
+   }
    bddnodes = newnodes;
 
+   newhash = (int*)bdd_tablerealloc(bddhash, sizeof(int)*bddnodesize);
+   if (newhash == NULL)
+   {
+      bddnodesize = oldsize;
+      return bdd_error(BDD_MEMORY);
+   }
+   bddhash = newhash;
+
    if (doRehash)
       for (n=0 ; n<oldsize ; n++)
-    bddnodes[n].hash = 0;
+    bddhash[n] = 0;
    
    for (n=oldsize ; n<bddnodesize ; n++)
    {
       bddnodes[n].refcou = 0;
-      bddnodes[n].hash = 0;
+      bddhash[n] = 0;
       LEVEL(n) = 0;
       LOW(n) = -1;
       bddnodes[n].next = n+1;
@@ -76,16 +76,21 @@
 
 /*=== SEMI-INTERNAL TYPES ==============================================*/
 
-typedef struct s_BddNode /* Node table entry */
+   /* Node table entry.  The entries are 16 bytes long and never straddle
+      a cache line.  The heads of the unique table chains are kept in the
+      separate bddhash table. */
+typedef struct s_BddNode
 {
    unsigned int refcou : 10;
    unsigned int level  : 22;
    int low;
    int high;
-   int hash;
    int next;
 } BddNode;
 
+   /* Fails to compile if a node is not 16 bytes long */
+typedef char BddNode_size_check[sizeof(BddNode) == 16 ? 1 : -1];
+
 
 /*=== KERNEL VARIABLES =================================================*/
 
@@ -93,21 +98,22 @@ typedef struct s_BddNode /* Node table entry */
 extern "C" {
 #endif
 
-extern int       bddrunning;         /* Flag - package initialized */
-extern int       bdderrorcond;       /* Some error condition was met */
-extern int       bddnodesize;        /* Number of allocated nodes */
-extern int       bddmaxnodesize;     /* Maximum allowed number of nodes */
-extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
-extern BddNode*  bddnodes;           /* All of the bdd nodes */
-extern int       bddvarnum;          /* Number of defined BDD variables */
-extern int*      bddrefstack;        /* Internal node reference stack */
-extern int*      bddrefstacktop;     /* Internal node reference stack top */
-extern int*      bddvar2level;
-extern int*      bddlevel2var;
-extern jmp_buf   bddexception;
-extern int       bddreorderdisabled;
-extern int       bddresized;
-extern bddCacheStat bddcachestats;
+extern BDD_THREAD_LOCAL int       bddrunning;         /* Flag - package initialized */
+extern BDD_THREAD_LOCAL int       bdderrorcond;       /* Some error condition was met */
+extern BDD_THREAD_LOCAL int       bddnodesize;        /* Number of allocated nodes */
+extern BDD_THREAD_LOCAL int       bddmaxnodesize;     /* Maximum allowed number of nodes */
+extern BDD_THREAD_LOCAL int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
+extern BDD_THREAD_LOCAL BddNode*  bddnodes;           /* All of the bdd nodes */
+extern BDD_THREAD_LOCAL int*      bddhash;            /* Unique table chain heads */
+extern BDD_THREAD_LOCAL int       bddvarnum;          /* Number of defined BDD variables */
+extern BDD_THREAD_LOCAL int*      bddrefstack;        /* Internal node reference stack */
+extern BDD_THREAD_LOCAL int*      bddrefstacktop;     /* Internal node reference stack top */
+extern BDD_THREAD_LOCAL int*      bddvar2level;
+extern BDD_THREAD_LOCAL int*      bddlevel2var;
+extern BDD_THREAD_LOCAL jmp_buf   bddexception;
+extern BDD_THREAD_LOCAL int       bddreorderdisabled;
+extern BDD_THREAD_LOCAL int       bddresized;
+extern BDD_THREAD_LOCAL bddCacheStat bddcachestats;
 
 #ifdef CPLUSPLUS
 }
@@ -154,6 +160,13 @@ extern bddCacheStat bddcachestats;
 #define LOWp(p)     ((p)->low)
 #define HIGHp(p)    ((p)->high)
 
+   /* Prefetching of a node before it is visited by a recursion */
+#if defined(__GNUC__)
+#define PREFETCH(a) __builtin_prefetch(&bddnodes[a])
+#else
+#define PREFETCH(a) ((void)0)
+#endif
+
    /* Stacking for garbage collector */
 #define INITREF    bddrefstacktop = bddrefstack
 #define PUSHREF(a) *(bddrefstacktop++) = (a)
@@ -187,6 +200,10 @@ extern "C" {
 #endif
 
 extern int    bdd_error(int);
+extern void*  bdd_tablealloc(size_t);
+extern void*  bdd_tablerealloc(void*, size_t);
+extern void   bdd_tablefree(void*);
+extern int    bdd_tablepagemode(void*);
 extern int    bdd_makenode(unsigned int, int, int);
 extern int    bdd_noderesize(int);
 extern void   bdd_checkreorder(void);
@@ -196,6 +213,7 @@ extern void   bdd_markcount(int, int*);
 extern void   bdd_unmark(int);
 extern void   bdd_unmark_upto(int, int);
 extern void   bdd_register_pair(bddPair*);
+extern int    bdd_renumbervars(int*);
 extern int   *fdddec2bin(int, uint64_t);
 
 extern int    bdd_operator_init(int);
@@ -63,19 +63,19 @@
 #define __USERESIZE /* FIXME */
 
    /* Current auto reord. method and number of automatic reorderings left */
-static int bddreordermethod;
-static int bddreordertimes;
+static BDD_THREAD_LOCAL int bddreordermethod;
+static BDD_THREAD_LOCAL int bddreordertimes;
 
    /* Flag for disabling reordering temporarily */
-static int reorderdisabled;
+static BDD_THREAD_LOCAL int reorderdisabled;
 
    /* Store for the variable relationships */
-static BddTree *vartree;
-static int blockid;
+static BDD_THREAD_LOCAL BddTree *vartree;
+static BDD_THREAD_LOCAL int blockid;
 
    /* Store for the ref.cou. of the external roots */
-static int *extroots;
-static int extrootsize;
+static BDD_THREAD_LOCAL int *extroots;
+static BDD_THREAD_LOCAL int extrootsize;
 
 /* Level data */
 typedef struct _levelData
@@ -86,28 +86,28 @@ typedef struct _levelData
    int nodenum;  /* Number of nodes in this level */
 } levelData;
 
-static levelData *levels; /* Indexed by variable! */
+static BDD_THREAD_LOCAL levelData *levels; /* Indexed by variable! */
 
    /* Interaction matrix */
-static imatrix *iactmtx;
+static BDD_THREAD_LOCAL imatrix *iactmtx;
 
    /* Reordering information for the user */
-static int verbose;
-static bddinthandler reorder_handler;
-static bddfilehandler reorder_filehandler;
-static bddsizehandler reorder_nodenum;
+static BDD_THREAD_LOCAL int verbose;
+static BDD_THREAD_LOCAL bddinthandler reorder_handler;
+static BDD_THREAD_LOCAL bddfilehandler reorder_filehandler;
+static BDD_THREAD_LOCAL bddsizehandler reorder_nodenum;
 
    /* Number of live nodes before and after a reordering session */
-static int usednum_before;
-static int usednum_after;
+static BDD_THREAD_LOCAL int usednum_before;
+static BDD_THREAD_LOCAL int usednum_after;
 	    
    /* Kernel variables needed for reordering */
-extern int bddfreepos;
-extern int bddfreenum;
-extern int bddproduced;
+extern BDD_THREAD_LOCAL int bddfreepos;
+extern BDD_THREAD_LOCAL int bddfreenum;
+extern BDD_THREAD_LOCAL int bddproduced;
 
    /* Flag telling us when a node table resize is done */
-static int resizedInMakenode;
+static BDD_THREAD_LOCAL int resizedInMakenode;
 
    /* New node hashing function for use with reordering */
 #define NODEHASH(var,l,h) ((PAIR((l),(h))%levels[var].size)+levels[var].start)
@@ -903,13 +903,13 @@ static int mark_roots(void)
 	 addDependencies(dep);
       }
 
-      /* Make sure the hash field is empty. This saves a loop in the
+      /* Make sure the hash chain head is empty. This saves a loop in the
 	 initial GBC */
-      node->hash = 0;
+      bddhash[n] = 0;
    }
 
-   bddnodes[0].hash = 0;
-   bddnodes[1].hash = 0;
+   bddhash[0] = 0;
+   bddhash[1] = 0;
 
    free(dep);
    return 0;
@@ -938,8 +938,8 @@ static void reorder_gbc(void)
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = bddhash[hash];
+	 bddhash[hash] = n;
 
       }
       else
@@ -988,7 +988,7 @@ static void reorder_rehashAll(void)
    bddfreepos = 0;
 
    for (n=bddnodesize-1 ; n>=0 ; n--)
-      bddnodes[n].hash = 0;
+      bddhash[n] = 0;
    
    for (n=bddnodesize-1 ; n>=2 ; n--)
    {
@@ -999,8 +999,8 @@ static void reorder_rehashAll(void)
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 node->next = bddhash[hash];
+	 bddhash[hash] = n;
       }
       else
       {
@@ -1038,7 +1038,7 @@ static int reorder_makenode(int var, int low, int high)
 
       /* Try to find an existing node of this kind */
    hash = NODEHASH(var, low, high);
-   res = bddnodes[hash].hash;
+   res = bddhash[hash];
       
    while(res != 0)
    {
@@ -1097,8 +1097,8 @@ static int reorder_makenode(int var, int low, int high)
    HIGHp(node) = high;
 
       /* Insert node in hash chain */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+   node->next = bddhash[hash];
+   bddhash[hash] = res;
 
       /* Make sure it is reference counted */
    node->refcou = 1;
@@ -1128,8 +1128,8 @@ static int reorder_downSimple(int var0)
    {
       int r;
 
-      r = bddnodes[n + vl0].hash;
-      bddnodes[n + vl0].hash = 0;
+      r = bddhash[n + vl0];
+      bddhash[n + vl0] = 0;
 
       while (r != 0)
       {
@@ -1139,8 +1139,8 @@ static int reorder_downSimple(int var0)
 	 if (VAR(LOWp(node)) != var1  &&  VAR(HIGHp(node)) != var1)
 	 {
  	       /* Node does not depend on next var, let it stay in the chain */
-	    node->next = bddnodes[n+vl0].hash;
-	    bddnodes[n+vl0].hash = r;
+	    node->next = bddhash[n+vl0];
+	    bddhash[n+vl0] = r;
 	    levels[var0].nodenum++;
 	 }
 	 else
@@ -1219,8 +1219,8 @@ static void reorder_swap(int toBeProcessed, int var0)
       
          /* Rehash the node since it got new childs */
       hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      node->next = bddhash[hash];
+      bddhash[hash] = toBeProcessed;
 
       toBeProcessed = next;
    }
@@ -1241,8 +1241,8 @@ static void reorder_localGbc(int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = bddhash[hash];
+      bddhash[hash] = 0;
 
       while (r)
       {
@@ -1251,8 +1251,8 @@ static void reorder_localGbc(int var0)
 
 	 if (node->refcou > 0)
 	 {
-	    node->next = bddnodes[hash].hash;
-	    bddnodes[hash].hash = r;
+	    node->next = bddhash[hash];
+	    bddhash[hash] = r;
 	 }
 	 else
 	 {
@@ -1343,8 +1343,8 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = bddhash[hash];
+      bddhash[hash] = 0;
 
       while (r)
       {
@@ -1388,8 +1388,8 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
       int next = node->next;
       int hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
 	 
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      node->next = bddhash[hash];
+      bddhash[hash] = toBeProcessed;
 
       toBeProcessed = next;
    }   
@@ -1420,7 +1420,7 @@ static void sanitycheck(void)
       
       for (n=0 ; n<levels[v].size ; n++)
       {
-	 r = bddnodes[n+levels[v].start].hash;
+	 r = bddhash[n+levels[v].start];
 	 
 	 while (r)
 	 {
@@ -1566,7 +1566,7 @@ int bdd_swapvar(int v1, int v2)
 
 void bdd_default_reohandler(int prestate)
 {
-   static long c1;
+   static BDD_THREAD_LOCAL long c1;
 
    if (verbose > 0)
    {
@@ -2180,6 +2180,78 @@ int bdd_intaddvarblock(int first, int last, int fixed)
 }
 
 
+/*
+NAME    {* bdd\_intinsvarnum *}
+SECTION {* reorder *}
+SHORT   {* inserts new BDD variables in the variable order *}
+PROTO   {* int bdd_intinsvarnum(int var, int num) *}
+DESCR   {* Inserts {\tt num} new variables having the indexes {\tt var}
+           to {\tt var+num-1}. The indexes of the variables {\tt var}
+	   and above are increased by {\tt num}. The new variables are
+	   placed in the variable order right after the variable
+	   {\tt var-1}, or first when {\tt var} is zero.
+
+	   The existing BDDs and variable pairs keep their meaning, only
+	   the indexes of their variables change. This function may
+	   {\em not} be used together with user defined variable blocks,
+	   the blocks must be cleared and defined again with the new
+	   indexes. *}
+RETURN  {* Zero on success, otherwise a negative error code. *}
+ALSO    {* bdd\_extvarnum, bdd\_intaddvarblock, bdd\_clrvarblocks *}
+*/
+int bdd_intinsvarnum(int var, int num)
+{
+   int oldnum = bddvarnum;
+   int *newvar;
+   int level, n, err;
+
+      /* Do not insert when variable-blocks are used */
+   if (vartree != NULL)
+      return bdd_error(BDD_VARBLK);
+   if (var < 0  ||  var > bddvarnum)
+      return bdd_error(BDD_VAR);
+   if (num < 0  ||  num > 0x3FFFFFFF)
+      return bdd_error(BDD_RANGE);
+   if (num == 0)
+      return 0;
+
+   if ((err=bdd_extvarnum(num)) < 0)
+      return err;
+
+   if ((newvar=NEW(int,bddvarnum)) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+      /* Move the new variables from the bottom of the order to the level
+       * following the variable var-1. The new variables have no
+       * dependencies and the swaps only exchange the level tables. */
+   level = var > 0 ? bddvar2level[var-1]+1 : 0;
+   if (level < oldnum)
+   {
+      if (reorder_init() < 0)
+      {
+	 free(newvar);
+	 return bdd_error(BDD_MEMORY);
+      }
+
+      for (n=0 ; n<num ; n++)
+	 while (bddvar2level[oldnum+n] > level+n)
+	    reorder_varup(oldnum+n);
+
+      reorder_done();
+   }
+
+      /* Give the new variables the indexes var to var+num-1 */
+   for (n=0 ; n<oldnum ; n++)
+      newvar[n] = n < var ? n : n+num;
+   for (n=0 ; n<num ; n++)
+      newvar[oldnum+n] = var+n;
+
+   err = bdd_renumbervars(newvar);
+   free(newvar);
+   return err;
+}
+
+
 /*
 NAME    {* bdd\_varblockall *}
 SECTION {* reorder *}
@@ -77,7 +77,8 @@ workspace "RulesAnalyzer"
 				"tests/test_network4.cpp",
 				"tests/test_network6.cpp",
 				"tests/test_analyzer4.cpp",
-				"tests/test_analyzer6.cpp"
+				"tests/test_analyzer6.cpp",
+				"tests/test_generator.cpp"
 			}
 
 			filter "system:linux"
@@ -85,3 +86,30 @@ workspace "RulesAnalyzer"
 			filter "system:windows"
 				buildoptions { "-utf-8" }
 				links { "Ws2_32", "buddy", "fmt", "gtest" }
+
+		project "bench"
+			kind "ConsoleApp"
+			language "C++"
+			cppdialect "C++14"
+			includedirs { "dep/buddy", "dep/fmtlib/include", "src" }
+
+			files {
+				"src/global.h",
+
+				"src/tools/*.h",
+				"src/tools/*.hpp",
+				"src/tools/*.cpp",
+				"src/tools/*.c",
+				"src/model/*.h",
+				"src/model/*.cpp",
+				"src/ostore/*.h",
+				"src/ostore/*.cpp",
+
+				"bench/main.cpp"
+			}
+
+			filter "system:linux"
+				links { "buddy", "fmt", "pthread" }
+			filter "system:windows"
+				buildoptions { "-utf-8" }
+				links { "Ws2_32", "buddy", "fmt" }
@@ -22,6 +22,7 @@
 #endif
 
 #include <linenoise/linenoise.h>
+#include <buddy/bdd.h>
 
 
 #include "cli/clibdd.h"
@@ -111,6 +112,10 @@ namespace cli {
 			catch (const interrupt_error& e) {
 				std::cout << e.what() << std::endl;
 			}
+			catch (const bddnodeerror& e) {
+				// the node table reached the max-memory ceiling.
+				std::cout << "** " << e.what() << " **" << std::endl;
+			}
 			catch (const std::exception& e) {
 				std::cout << e.what() << std::endl;
 			}
@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <map>
+
+#include "tools/strutil.h"
 #include "fmt/core.h"
 
 namespace cli {
@@ -17,7 +19,11 @@ namespace cli {
 	static const std::map<CliCommandFlag, std::string> OPTION_TEXTS {
 		{ CliCommandFlag::OutputToFile, "-o" },
 		{ CliCommandFlag::ZoneFilter,   "-z" },
-		{ CliCommandFlag::IncludeAny,   "-any" }
+		{ CliCommandFlag::IncludeAny,   "-any" },
+		{ CliCommandFlag::Jobs,         "-jobs" },
+		{ CliCommandFlag::Profile,      "-profile" },
+		{ CliCommandFlag::MinimalExplanation, "-minimal" },
+		{ CliCommandFlag::Fast,         "-fast" }
 	};
 
 
@@ -28,16 +34,23 @@ namespace cli {
 
 
 	CliArgs::CliArgs(const std::vector<std::string>& args) :
-		std::deque<std::string>()
+		std::deque<std::string>(),
+		_jobs{ 1 }
 	{
 		bool output_option = false;		// set to true when a -o is found
 		int zone_option = 0;			// counter used when a -z is found
+		bool jobs_option = false;		// set to true when a -jobs is found
 
 		for (const std::string& arg : args) {
 			if (output_option) {
 				_output_filename = arg;
 				output_option = false;
 			}
+			else if (jobs_option) {
+				if (!rat::str2i(arg, _jobs) || _jobs < 1)
+					throw std::runtime_error(fmt::format("invalid number of jobs '{}'", arg));
+				jobs_option = false;
+			}
 			else if (zone_option == 2) {
 				_src_zone = arg;
 				zone_option -= 1;
@@ -66,6 +79,31 @@ namespace cli {
 				_flags.add(CliCommandFlag::ZoneFilter);
 				zone_option = 2;
 			}
+			else if (arg.compare("-jobs") == 0) {
+				if (_flags.contains(CliCommandFlag::Jobs))
+					throw std::runtime_error("duplicate -jobs option");
+
+				_flags.add(CliCommandFlag::Jobs);
+				jobs_option = true;
+			}
+			else if (arg.compare("-profile") == 0) {
+				if (_flags.contains(CliCommandFlag::Profile))
+					throw std::runtime_error("duplicate -profile option");
+
+				_flags.add(CliCommandFlag::Profile);
+			}
+			else if (arg.compare("-minimal") == 0) {
+				if (_flags.contains(CliCommandFlag::MinimalExplanation))
+					throw std::runtime_error("duplicate -minimal option");
+
+				_flags.add(CliCommandFlag::MinimalExplanation);
+			}
+			else if (arg.compare("-fast") == 0) {
+				if (_flags.contains(CliCommandFlag::Fast))
+					throw std::runtime_error("duplicate -fast option");
+
+				_flags.add(CliCommandFlag::Fast);
+			}
 			else if (arg[0] == '-') {
 				throw std::runtime_error(fmt::format("invalid command line option {}", arg));
 			}
@@ -79,6 +117,9 @@ namespace cli {
 
 		if (zone_option > 0)
 			throw std::runtime_error("missing zone in option -z");
+
+		if (jobs_option)
+			throw std::runtime_error("missing number in option -jobs");
 	}
 
 
@@ -27,7 +27,11 @@ namespace cli {
 	enum class CliCommandFlag {
 		OutputToFile,           // -o   : output to file option
 		IncludeAny,             // -any : include "any" objects option
-		ZoneFilter              // -z   : zone filter option
+		ZoneFilter,             // -z   : zone filter option
+		Jobs,                   // -jobs : number of worker processes option
+		Profile,                // -profile : show the profile of the analysis option
+		MinimalExplanation,     // -minimal : report a minimal set of rules explaining an anomaly
+		Fast                    // -fast : classify the anomalies without explaining them
 	};
 
 
@@ -80,6 +84,10 @@ namespace cli {
 		*/
 		const std::string& dst_zone() const { return _dst_zone; }
 
+		/* Returns the number of worker processes in -jobs option.
+		*/
+		int jobs() const { return _jobs; }
+
 		/* Returns other flags present on the command line.
 		*/
 		const std::vector<CliCommandFlag> flags() const { return _flags.options(); }
@@ -96,6 +104,9 @@ namespace cli {
 		std::string _src_zone;
 		std::string _dst_zone;
 
+		// -jobs number of worker processes
+		int _jobs;
+
 		// other flags
 		CliCommandFlags _flags;
 	};
@@ -8,8 +8,12 @@
 #include "cli/clibdd.h"
 
 #include <cstdio>
+#include <ctime>
 #include <buddy/bdd.h>
 
+#include "model/domains.h"
+#include "ostore/ostoreconfig.h"
+
 
 cli::CliBddCommand::CliBddCommand(CliContext& context) :
 	CliCommandMap(context)
@@ -43,6 +47,23 @@ void cli::CliBddInfoCommand::do_execute(CliArgs& args, const CliCtrlcGuard& ctrl
 	printf("number of bdd variables                 : %d\n", stat.varnum);
 	printf("size of internal cache                  : %d\n", stat.cachesize);
 	printf("number of garbage collections done      : %d\n", stat.gbcnum);
+	printf("time used for garbage collections (ms)  : %.3f\n", stat.gbctime * 1000.0 / CLOCKS_PER_SEC);
+	printf("maximum number of nodes in use          : %d\n", stat.peaknodes);
+	printf("number of nodes in use                  : %d\n", bdd_getnodenum());
+	printf("pages backing the node table            : %s\n", fos::page_mode_name(bdd_getpagemode()).c_str());
+
+	// Print variable order statistics
+	const fwm::Domains& domains = fwm::Domains::get();
+
+	printf("\nVariable order\n");
+	printf("--------------\n");
+	printf("initial variable order                  : %s\n", to_string(domains.variable_order()).c_str());
+	printf("reorder method                          : %s\n", to_string(domains.reorder_method()).c_str());
+	printf("number of reorderings done              : %d\n", domains.reorder_count());
+	printf("time used for reorderings (ms)          : %.3f\n", domains.reorder_time());
+	printf("\n");
+	const fwm::Table variables_table = domains.variables_table();
+	write_table(variables_table, ctrlc_guard);
 
 	// Print cache statistics
 	bdd_printstat();
@@ -18,6 +18,7 @@
 namespace cli {
 
 	cli::CliContext::CliContext(const OstoreConfig& config) :
+		config{ config },
 		ostore{ fos::ObjectStore{ config } },
 		network{ fwm::Network{ config.model_config } },
 		ctrlc_handler{},
@@ -30,6 +30,9 @@ namespace cli {
 	public:
 		CliContext(const OstoreConfig& config);
 
+		// The application configuration.
+		const OstoreConfig config;
+
 		// A store for all firewall objects.
 		ObjectStore ostore;
 
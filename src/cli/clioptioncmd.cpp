@@ -32,6 +32,9 @@ namespace cli {
 			context.network.model_options.add(ModelOption::User);
 		else
 			report_unknown_model_option(args.front());
+
+		// The bdd of all rules depend on the model options.
+		context.network.clear_rule_bdds();
 	}
 
 
@@ -49,6 +52,9 @@ namespace cli {
 			context.network.model_options.remove(ModelOption::User);
 		else
 			report_unknown_model_option(args.front());
+
+		// The bdd of all rules depend on the model options.
+		context.network.clear_rule_bdds();
 	}
 
 }
@@ -9,17 +9,23 @@
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include <buddy/bdd.h>
+
 #include "model/analyzer.h"
 #include "model/anomaly.h"
+#include "model/anomalysink.h"
 #include "model/comparator.h"
 #include "model/firewall.h"
 #include "model/packettester.h"
+#include "model/profiler.h"
 #include "model/rule.h"
 #include "model/rulelist.h"
 #include "model/service.h"
@@ -32,6 +38,53 @@
 
 namespace cli {
 
+	/*
+	 * Reports the size and the hit rate of the bdd operator caches during
+	 * an analysis.  Only the operations of the current process are counted.
+	*/
+	class CliCacheReport final
+	{
+	public:
+		CliCacheReport() :
+			_start_stats{},
+			_start_size{ bdd_getcachesize() }
+		{
+			bdd_cachestats(&_start_stats);
+		}
+
+		void log(Logger& logger) const
+		{
+			bddCacheStat end_stats;
+			bdd_cachestats(&end_stats);
+			const int end_size = bdd_getcachesize();
+
+			const size_t hits = end_stats.opHit - _start_stats.opHit;
+			const size_t lookups = hits + end_stats.opMiss - _start_stats.opMiss;
+			if (lookups == 0)
+				return;
+
+			const double hit_rate = 100.0 * hits / lookups;
+			if (_start_size == end_size)
+				logger.info(
+					"operator cache %d entries, hit rate %.1f%%",
+					end_size,
+					hit_rate
+				);
+			else
+				logger.info(
+					"operator cache resized from %d to %d entries, hit rate %.1f%%",
+					_start_size,
+					end_size,
+					hit_rate
+				);
+		}
+
+	private:
+		bddCacheStat _start_stats;
+		const int _start_size;
+	};
+
+
 	CliFwCheckCommand::CliFwCheckCommand(CliContext& context) :
 		CliCommandMap(context)
 	{
@@ -39,6 +92,7 @@ namespace cli {
 		add("deny",                              new CliFwCheckDenyCommand(context));
 		add("anomaly",                           new CliFwCheckAnomalyCommand(context));
 		add("symmetry",                          new CliFwCheckSymmetryCommand(context));
+		add("duplicate",                         new CliFwCheckDuplicateCommand(context));
 		add("equivalence",                       new CliFwCheckEquivalenceCommand(context));
 		add(CommandKeys{ "addr", "address" },    new CliFwCheckAddressCommand(context));
 		add(CommandKeys{ "svc",  "service" },    new CliFwCheckServiceCommand(context));
@@ -169,7 +223,11 @@ namespace cli {
 	CliFwCheckAnomalyCommand::CliFwCheckAnomalyCommand(CliContext& context) :
 		CliCommand(context, 0, 0, new CliCommandFlags({
 										CliCommandFlag::OutputToFile,
-										CliCommandFlag::ZoneFilter }))
+										CliCommandFlag::ZoneFilter,
+										CliCommandFlag::Jobs,
+										CliCommandFlag::Profile,
+										CliCommandFlag::MinimalExplanation,
+										CliCommandFlag::Fast }))
 	{
 	}
 
@@ -191,13 +249,90 @@ namespace cli {
 		const RuleList filtered_rules = zones_filter ? acl.filter(zones_filter.value()) : acl;
 
 		// allocate the analyzer
-		const Analyzer analyzer{ filtered_rules, context.network.config().ip_model };
+		Analyzer analyzer{ filtered_rules, context.network.config().ip_model };
+
+		if (args.has_option(CliCommandFlag::MinimalExplanation) && args.has_option(CliCommandFlag::Fast))
+			throw std::runtime_error("options -minimal and -fast are mutually exclusive");
+
+		// report a minimal set of rules explaining the fully masked rules
+		if (args.has_option(CliCommandFlag::MinimalExplanation))
+			analyzer.set_explanation(RuleAnomalyExplanation::MinimalRules);
+
+		// only classify the rules, the related rules are searched by 'fw show anomaly'
+		if (args.has_option(CliCommandFlag::Fast))
+			analyzer.set_explanation(RuleAnomalyExplanation::NoRules);
+
+		// measure the phases of the analysis if requested
+		Profiler profiler;
+		if (args.has_option(CliCommandFlag::Profile)) {
+			analyzer.set_profiler(&profiler);
+			profiler.start();
+		}
+
+		// The anomalies are streamed when they are written to a csv or a json
+		// lines file, nothing is kept in memory.
+		const std::string& output_file = args.output_file();
+		const bool stream_output =
+			args.has_option(CliCommandFlag::OutputToFile) &&
+			(rat::iends_with(output_file, ".csv") || rat::iends_with(output_file, ".jsonl"));
+
+		// the worker processes analyze independent slices of the acl, the results
+		// are merged in the acl order.
+		const int jobs = args.has_option(CliCommandFlag::Jobs) ? args.jobs() : 1;
+
+		if (stream_output && !ask_write_to_file(output_file))
+			return;
 
 		// search for anomalies
+		const CliCacheReport cache_report;
 		const auto start_time = std::chrono::steady_clock::now();
-		const RuleAnomalies anomalies = analyzer.check_anomaly(ctrlc_guard.get_interrupt_cb());
+		RuleAnomalies anomalies;
+		size_t anomaly_count = 0;
+		if (stream_output) {
+			std::ofstream ofs{ output_file, std::ofstream::out };
+			if (!ofs.good())
+				throw std::runtime_error("can't open file");
+
+			std::unique_ptr<RuleAnomalySink> sink;
+			if (rat::iends_with(output_file, ".csv"))
+				sink = std::make_unique<RuleAnomalyCsvSink>(ofs, acl.have_names());
+			else
+				sink = std::make_unique<RuleAnomalyJsonSink>(ofs, acl.have_names());
+
+			// reuse the results of the previous analysis of the acl.
+			analyzer.check_anomaly(
+				jobs,
+				*sink,
+				zones_filter ? nullptr : &firewall.anomaly_cache(),
+				ctrlc_guard.get_interrupt_cb()
+			);
+
+			anomaly_count = sink->count();
+			anomalies.missing_deny_all = sink->missing_deny_all;
+		}
+		else if (jobs > 1) {
+			// reuse the results of the previous analysis of the acl.
+			anomalies = analyzer.check_anomaly(
+				jobs,
+				zones_filter ? nullptr : &firewall.anomaly_cache(),
+				ctrlc_guard.get_interrupt_cb()
+			);
+			anomaly_count = anomalies.size();
+		}
+		else if (!zones_filter) {
+			// reuse the results of the previous analysis of the acl.
+			anomalies = analyzer.check_anomaly(firewall.anomaly_cache(), ctrlc_guard.get_interrupt_cb());
+			anomaly_count = anomalies.size();
+		}
+		else {
+			anomalies = analyzer.check_anomaly(ctrlc_guard.get_interrupt_cb());
+			anomaly_count = anomalies.size();
+		}
+
+		if (args.has_option(CliCommandFlag::Profile))
+			profiler.stop();
 
-		if (anomalies.empty()) {
+		if (anomaly_count == 0) {
 			context.logger->info("no anomalies found");
 
 		}
@@ -215,21 +350,39 @@ namespace cli {
 			if (anomalies.missing_deny_all)
 				context.logger->warning("a deny all rule is missing");
 
-			const Table anomalies_table = anomalies.output_anomalies(acl.have_names());
-
-			if (args.has_option(CliCommandFlag::OutputToFile)) {
-				const std::string& output_file = args.output_file();
+			if (args.has_option(CliCommandFlag::Fast))
+				context.logger->info("use 'fw show anomaly <rule-id>' to explain an anomaly");
 
-				if (write_table(output_file, anomalies_table, ctrlc_guard))
-					context.logger->info("%zu anomalies written to '%s'",
-						anomalies_table.row_count(),
-						output_file.c_str()
-					);
+			if (stream_output) {
+				context.logger->info("%zu anomalies written to '%s'",
+					anomaly_count,
+					output_file.c_str()
+				);
 			}
 			else {
-				write_table(anomalies_table, ctrlc_guard);
+				const Table anomalies_table = anomalies.output_anomalies(acl.have_names());
+
+				if (args.has_option(CliCommandFlag::OutputToFile)) {
+					if (write_table(output_file, anomalies_table, ctrlc_guard))
+						context.logger->info("%zu anomalies written to '%s'",
+							anomalies_table.row_count(),
+							output_file.c_str()
+						);
+				}
+				else {
+					write_table(anomalies_table, ctrlc_guard);
+				}
 			}
 		}
+
+		// the caches of the worker processes are not reported.
+		if (jobs <= 1)
+			cache_report.log(*context.logger);
+
+		if (args.has_option(CliCommandFlag::Profile)) {
+			write_table(profiler.phases_table(), ctrlc_guard);
+			write_table(profiler.summary_table(), ctrlc_guard);
+		}
 	}
 
 
@@ -237,7 +390,7 @@ namespace cli {
 		CliCommand(context, 0, 0, new CliCommandFlags({
 										CliCommandFlag::OutputToFile,
 										CliCommandFlag::ZoneFilter,
-										CliCommandFlag::ZoneFilter }))
+										CliCommandFlag::Profile }))
 	{
 	}
 
@@ -259,11 +412,22 @@ namespace cli {
 		const RuleList filtered_rules = zones_filter ? acl.filter(zones_filter.value()) : acl;
 
 		// allocate the analyzer
-		const Analyzer analyzer{ filtered_rules, context.network.config().ip_model };
+		Analyzer analyzer{ filtered_rules, context.network.config().ip_model };
+
+		// measure the phases of the analysis if requested
+		Profiler profiler;
+		if (args.has_option(CliCommandFlag::Profile)) {
+			analyzer.set_profiler(&profiler);
+			profiler.start();
+		}
 
 		// search for symmetrical rules.
+		const CliCacheReport cache_report;
 		const std::list<RulePair> symmetrical_rules = analyzer.check_symmetry(true, ctrlc_guard.get_interrupt_cb());
 
+		if (args.has_option(CliCommandFlag::Profile))
+			profiler.stop();
+
 		if (symmetrical_rules.empty()) {
 			context.logger->info("no symmetrical rules found");
 		}
@@ -291,11 +455,129 @@ namespace cli {
 				write_table(rules_table, ctrlc_guard);
 			}
 		}
+		cache_report.log(*context.logger);
+
+		if (args.has_option(CliCommandFlag::Profile)) {
+			write_table(profiler.phases_table(), ctrlc_guard);
+			write_table(profiler.summary_table(), ctrlc_guard);
+		}
+	}
+
+
+	CliFwCheckDuplicateCommand::CliFwCheckDuplicateCommand(CliContext& context) :
+		CliCommand(context, 0, 5, new CliCommandFlags({
+										CliCommandFlag::OutputToFile,
+										CliCommandFlag::ZoneFilter,
+										CliCommandFlag::Profile }))
+	{
+	}
+
+
+	void CliFwCheckDuplicateCommand::do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard)
+	{
+		const Firewall& firewall = context.get_current_firewall();
+
+		const RuleList acl = firewall.acl();
+		if (acl.size() == 0) {
+			context.logger->warning("firewall acl is empty");
+			return;
+		}
+
+		// get the criteria ignored when comparing the rules
+		Predicate::BddOptions bdd_options({
+			Predicate::BddOption::SourceZone,
+			Predicate::BddOption::DestinationZone,
+			Predicate::BddOption::Application,
+			Predicate::BddOption::User,
+			Predicate::BddOption::Url
+		});
+
+		const bool ignore_criteria = !args.empty();
+		while (!args.empty()) {
+			const std::string criterion = args.pop();
+
+			if (criterion == "src.zone")
+				bdd_options.remove(Predicate::BddOption::SourceZone);
+			else if (criterion == "dst.zone")
+				bdd_options.remove(Predicate::BddOption::DestinationZone);
+			else if (criterion == "app")
+				bdd_options.remove(Predicate::BddOption::Application);
+			else if (criterion == "user")
+				bdd_options.remove(Predicate::BddOption::User);
+			else if (criterion == "url")
+				bdd_options.remove(Predicate::BddOption::Url);
+			else
+				throw std::runtime_error(fmt::format("invalid criterion '{}'", criterion));
+		}
+
+		// get the zones filter from the command line
+		ZonePairOptArg zones_filter = get_zones_filter(args);
+
+		// get the rules filtered using the optional zones filter
+		const RuleList filtered_rules = zones_filter ? acl.filter(zones_filter.value()) : acl;
+
+		// allocate the analyzer
+		Analyzer analyzer{ filtered_rules, context.network.config().ip_model };
+
+		// measure the phases of the analysis if requested
+		Profiler profiler;
+		if (args.has_option(CliCommandFlag::Profile)) {
+			analyzer.set_profiler(&profiler);
+			profiler.start();
+		}
+
+		// search for duplicate rules.
+		const CliCacheReport cache_report;
+		const std::list<RuleList> duplicate_rules = ignore_criteria
+			? analyzer.check_duplicate(bdd_options, ctrlc_guard.get_interrupt_cb())
+			: analyzer.check_duplicate(ctrlc_guard.get_interrupt_cb());
+
+		if (args.has_option(CliCommandFlag::Profile))
+			profiler.stop();
+
+		if (duplicate_rules.empty()) {
+			context.logger->info("no duplicate rules found");
+		}
+		else {
+			context.logger->info("%zu %s of duplicate rules found",
+				duplicate_rules.size(),
+				rat::pluralize(duplicate_rules.size(), "group").c_str());
+
+			Table rules_table{ {"group", "action", "rule ids"} };
+			int group_id = 0;
+			for (const RuleList& group : duplicate_rules) {
+				Row& row = rules_table.add_row();
+
+				row.cell(0).append(++group_id);
+				row.cell(1).append(group.front()->action() == RuleAction::ALLOW ? "allow" : "deny");
+				row.cell(2).append(group.id_list());
+			}
+
+			if (args.has_option(CliCommandFlag::OutputToFile)) {
+				const std::string& output_file{ args.output_file() };
+
+				if (write_table(output_file, rules_table, ctrlc_guard))
+					context.logger->info("%zu groups written to '%s'",
+						rules_table.row_count(),
+						output_file.c_str());
+			}
+			else {
+				write_table(rules_table, ctrlc_guard);
+			}
+		}
+		cache_report.log(*context.logger);
+
+		if (args.has_option(CliCommandFlag::Profile)) {
+			write_table(profiler.phases_table(), ctrlc_guard);
+			write_table(profiler.summary_table(), ctrlc_guard);
+		}
 	}
 
 
 	CliFwCheckEquivalenceCommand::CliFwCheckEquivalenceCommand(CliContext& context) :
-		CliCommand(context, 1, 1, new CliCommandFlags({ CliCommandFlag::ZoneFilter }))
+		CliCommand(context, 1, 1, new CliCommandFlags({
+										CliCommandFlag::ZoneFilter,
+										CliCommandFlag::Profile }))
 	{
 	}
 
@@ -322,8 +604,21 @@ namespace cli {
 										? firewall2->acl().filter(zones_filter.value())
 										: firewall2->acl();
 
+		// measure the phases of the comparison if requested
+		Profiler profiler;
+		if (args.has_option(CliCommandFlag::Profile))
+			profiler.start();
+
 		// run the policy comparator
-		const PolicylistRelationShip relation = PolicyListComparator::compare(rule_list1, rule_list2);
+		const CliCacheReport cache_report;
+		const PolicylistRelationShip relation = PolicyListComparator::compare(
+			rule_list1,
+			rule_list2,
+			args.has_option(CliCommandFlag::Profile) ? &profiler : nullptr
+		);
+
+		if (args.has_option(CliCommandFlag::Profile))
+			profiler.stop();
 
 		// output the comparison results
 		if (relation.allowed == MnodeRelationship::equal && relation.denied == MnodeRelationship::equal) {
@@ -335,6 +630,12 @@ namespace cli {
 			context.logger->warning(" allowed traffic : %s", to_string(relation.allowed).c_str());
 			context.logger->warning(" denied traffic  : %s", to_string(relation.denied).c_str());
 		}
+		cache_report.log(*context.logger);
+
+		if (args.has_option(CliCommandFlag::Profile)) {
+			write_table(profiler.phases_table(), ctrlc_guard);
+			write_table(profiler.summary_table(), ctrlc_guard);
+		}
 	}
 
 
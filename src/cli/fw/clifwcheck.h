@@ -62,6 +62,16 @@ namespace cli {
 	};
 
 
+	class CliFwCheckDuplicateCommand : public CliCommand
+	{
+	public:
+		CliFwCheckDuplicateCommand(CliContext& context);
+
+	protected:
+		virtual void do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard) override;
+	};
+
+
 	class CliFwCheckEquivalenceCommand : public CliCommand
 	{
 	public:
@@ -96,6 +96,9 @@ namespace cli {
 			firewall.network().model_options.add(ModelOption::Url);
 		else
 			report_unknown_model_option(args.front());
+
+		// The bdd of all rules depend on the model options.
+		firewall.network().clear_rule_bdds();
 	}
 
 
@@ -117,5 +120,8 @@ namespace cli {
 			firewall.network().model_options.remove(ModelOption::Url);
 		else
 			report_unknown_model_option(args.front());
+
+		// The bdd of all rules depend on the model options.
+		firewall.network().clear_rule_bdds();
 	}
 }
@@ -13,6 +13,8 @@
 #include <string>
 
 #include "model/address.h"
+#include "model/analyzer.h"
+#include "model/anomaly.h"
 #include "model/firewall.h"
 #include "model/rule.h"
 #include "model/table.h"
@@ -30,6 +32,7 @@ namespace cli {
 		add("zones",                              new CliFwShowZonesCommand(context));
 		add("rule",                               new CliFwShowRuleCommand(context));
 		add("rules",                              new CliFwShowRulesCommand(context));
+		add("anomaly",                            new CliFwShowAnomalyCommand(context));
 		add(CommandKeys{ "address",     "addr" }, new CliFwShowAddressesCommand(context));
 		add(CommandKeys{ "service",     "svc" },  new CliFwShowServicesCommand(context));
 		add(CommandKeys{ "application", "app" },  new CliFwShowApplicationsCommand(context));
@@ -113,6 +116,63 @@ namespace cli {
 	}
 
 
+	CliFwShowAnomalyCommand::CliFwShowAnomalyCommand(CliContext& context) :
+		CliCommand(context, 1, 1, new CliCommandFlags({
+										CliCommandFlag::OutputToFile,
+										CliCommandFlag::MinimalExplanation }))
+	{
+	}
+
+
+	void CliFwShowAnomalyCommand::do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard)
+	{
+		Firewall& firewall = context.get_current_firewall();
+
+		const RuleList acl = firewall.acl();
+		if (acl.size() == 0) {
+			context.logger->warning("firewall acl is empty");
+			return;
+		}
+
+		int rule_id;
+		if (!rat::str2i(args.pop(), rule_id) || rule_id < 0)
+			report_invalid_rule_id();
+
+		const Rule* rule = firewall.get_rule(rule_id);
+		if (rule == nullptr)
+			report_rule_id_not_found(rule_id);
+
+		if (rule->status() != RuleStatus::ENABLED) {
+			context.logger->warning("rule id '%d' is disabled", rule_id);
+			return;
+		}
+
+		// The anomaly is explained whatever the mode used by 'fw check anomaly',
+		// only the rules preceding this rule are replayed.
+		Analyzer analyzer{ acl, context.network.config().ip_model };
+		if (args.has_option(CliCommandFlag::MinimalExplanation))
+			analyzer.set_explanation(RuleAnomalyExplanation::MinimalRules);
+
+		RuleAnomalies anomalies;
+		RuleAnomalyPtr anomaly = analyzer.check_anomaly(*rule, &firewall.anomaly_cache(), ctrlc_guard.get_interrupt_cb());
+		if (!anomaly) {
+			context.logger->info("rule id '%d' has no anomaly", rule_id);
+			return;
+		}
+		anomalies.push_back(std::move(anomaly));
+
+		const Table anomalies_table = anomalies.output_anomalies(acl.have_names());
+		if (args.has_option(CliCommandFlag::OutputToFile)) {
+			const std::string& output_file{ args.output_file() };
+			if (write_table(output_file, anomalies_table, ctrlc_guard))
+				context.logger->info("anomaly written to '%s'", output_file.c_str());
+		}
+		else {
+			write_table(anomalies_table, ctrlc_guard);
+		}
+	}
+
+
 	CliFwShowRulesCommand::CliFwShowRulesCommand(CliContext& context) :
 		CliCommand(context, 0, 0, new CliCommandFlags({
 										CliCommandFlag::OutputToFile,
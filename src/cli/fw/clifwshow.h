@@ -47,6 +47,16 @@ namespace cli {
 	};
 
 
+	class CliFwShowAnomalyCommand : public CliCommand
+	{
+	public:
+		explicit CliFwShowAnomalyCommand(CliContext& context);
+
+	protected:
+		virtual void do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard) override;
+	};
+
+
 	class CliFwShowRulesCommand : public CliCommand
 	{
 	public:
@@ -7,6 +7,7 @@
 */
 #include "cli/nw/clinw.h"
 
+#include "cli/nw/clinwgenerate.h"
 #include "cli/nw/clinwlist.h"
 #include "model/firewall.h"
 
@@ -20,6 +21,7 @@ namespace cli {
 		context.add_firewall("default");
 
 		add(CommandKeys{ "l", "list" }, new CliNwListCommand(context));
+		add(CommandKeys{ "g", "generate" }, new CliNwGenerateCommand(context));
 	}
 
 }
@@ -0,0 +1,90 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "cli/nw/clinwgenerate.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "ostore/policygenerator.h"
+#include "tools/strutil.h"
+#include "fmt/core.h"
+
+
+namespace cli {
+
+	CliNwGenerateCommand::CliNwGenerateCommand(CliContext& context) :
+		CliCommand(context, 1, 9, new CliCommandFlags())
+	{
+	}
+
+
+	void CliNwGenerateCommand::do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard)
+	{
+		const std::string prefix{ args.pop() };
+
+		PolicyGeneratorConfig config;
+		config.csv_list_delimiter = context.config.loader_config.reader_config.csv_list_delimiter;
+
+		// By default, the share of IPv6 addresses follows the address model.
+		switch (context.network.config().ip_model) {
+		case IPAddressModel::IP4Model:
+			config.ipv6_ratio = 0;
+			break;
+		case IPAddressModel::IP6Model:
+			config.ipv6_ratio = 100;
+			break;
+		default:
+			config.ipv6_ratio = 25;
+			break;
+		}
+
+		while (!args.empty()) {
+			const std::string arg{ args.pop() };
+			const size_t pos = arg.find('=');
+			const std::string name = pos == std::string::npos ? arg : arg.substr(0, pos);
+			const std::string value = pos == std::string::npos ? "" : arg.substr(pos + 1);
+
+			int number;
+			if (!rat::str2i(value, number))
+				throw std::runtime_error(fmt::format("invalid parameter '{}'", arg));
+
+			if (rat::iequal(name, "rules"))
+				config.rule_count = number;
+			else if (rat::iequal(name, "zones"))
+				config.zone_count = number;
+			else if (rat::iequal(name, "depth"))
+				config.group_depth = number;
+			else if (rat::iequal(name, "overlap"))
+				config.overlap_ratio = number;
+			else if (rat::iequal(name, "negate"))
+				config.negate_ratio = number;
+			else if (rat::iequal(name, "ipv6"))
+				config.ipv6_ratio = number;
+			else if (rat::iequal(name, "app"))
+				config.app_ratio = number;
+			else if (rat::iequal(name, "seed"))
+				config.seed = static_cast<uint32_t>(number);
+			else
+				throw std::runtime_error(fmt::format("invalid parameter '{}'", arg));
+		}
+
+		if (config.ipv6_ratio > 0 && context.network.config().ip_model == IPAddressModel::IP4Model)
+			context.logger->warning("IPv6 addresses are not loaded with the IPv4 address model");
+
+		PolicyGenerator generator{ config };
+		const PolicyFiles files = generator.generate(prefix);
+
+		context.logger->info(
+			"%d %s generated, load the policy with 'exec %s'",
+			config.rule_count,
+			rat::pluralize(config.rule_count, "rule").c_str(),
+			files.script.c_str()
+		);
+	}
+
+}
@@ -0,0 +1,26 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include "cli/clicmd.h"
+#include "cli/clicontext.h"
+
+
+namespace cli {
+
+	class CliNwGenerateCommand : public CliCommand
+	{
+	public:
+		explicit CliNwGenerateCommand(CliContext& context);
+
+	protected:
+		virtual void do_execute(CliArgs& args, const CliCtrlcGuard& ctrlc_guard) override;
+	};
+
+}
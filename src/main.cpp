@@ -9,6 +9,7 @@
 #include <cstring>
 #include <memory>
 #include <stdexcept>
+#include <buddy/bdd.h>
 
 #include "cli/cli.h"
 #include "model/domains.h"
@@ -62,9 +63,24 @@ int main(int ac, char** av)
 			to_string(config.model_config.ip_model).c_str(),
 			config.model_config.strict_ip_parser ? "yes" : "no"
 		);
-		logger->info("* memory nodes=%d cache=%d",
+		logger->info("* memory nodes=%d cache=%d pages=%s",
 			config.buddy_config.node_size,
-			config.buddy_config.cache_size
+			config.buddy_config.cache_size,
+			fos::page_mode_name(config.buddy_config.page_mode).c_str()
+		);
+		logger->info("* node table max-increase=%d min-free-nodes=%d%% max-memory=%dMB",
+			config.buddy_config.max_increase,
+			config.buddy_config.min_free_nodes,
+			config.buddy_config.max_memory
+		);
+		if (config.buddy_config.max_cache_size > 0)
+			logger->info("* adaptive cache min-cache=%d max-cache=%d",
+				config.buddy_config.min_cache_size,
+				config.buddy_config.max_cache_size
+			);
+		logger->info("* variable order %s, reorder: %s",
+			to_string(config.buddy_config.variable_order).c_str(),
+			to_string(config.buddy_config.reorder_method).c_str()
 		);
 
 		if (config.logger_config.enable) {
@@ -78,7 +94,22 @@ int main(int ac, char** av)
 		// Initialize the model domains.
 		fwm::Domains& domains = fwm::Domains::get();
 		logger->info("allocating memory");
-		domains.init_bdd(config.buddy_config.node_size, config.buddy_config.cache_size);
+		bdd_setpagemode(config.buddy_config.page_mode);
+		domains.init_bdd(
+			config.buddy_config.node_size,
+			config.buddy_config.cache_size,
+			config.buddy_config.variable_order,
+			config.buddy_config.reorder_method
+		);
+		domains.set_growth_policy(
+			config.buddy_config.max_increase,
+			config.buddy_config.min_free_nodes,
+			config.buddy_config.max_memory
+		);
+		domains.set_cache_budget(
+			config.buddy_config.min_cache_size,
+			config.buddy_config.max_cache_size
+		);
 
 		// Run the command line interpreter.
 		cli::Cli cli{ config };
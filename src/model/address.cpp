@@ -7,13 +7,16 @@
 */
 #include "model/address.h"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "model/domain.h"
 #include "model/domains.h"
+#include "model/intervalset.h"
 #include "model/ipv4parser.h"
 #include "model/ipv6parser.h"
 #include "model/moptions.h"
@@ -22,6 +25,44 @@
 
 namespace fwm {
 
+	namespace {
+
+		/* Returns a bdd testing if an address is one of the given addresses.
+		 *
+		 * The address ranges are grouped by domain and merged into a sorted
+		 * list of disjoint intervals.  The bdd is then built from the merged
+		 * intervals instead of the individual addresses.
+		*/
+		template<typename T>
+		bdd make_addresses_bdd(const std::vector<const T*>& addresses)
+		{
+			std::vector<std::pair<const Domain*, IntervalSet>> sets;
+
+			for (const T* address : addresses) {
+				const Mvalue& value = address->value();
+				const Domain* domain = &value.domain();
+
+				auto it = std::find_if(
+					sets.begin(),
+					sets.end(),
+					[domain](const std::pair<const Domain*, IntervalSet>& set) { return set.first == domain; }
+				);
+				if (it == sets.end())
+					it = sets.insert(sets.end(), { domain, IntervalSet() });
+
+				it->second.add(value.range().lower_value(), value.range().upper_value());
+			}
+
+			bdd condition{ bddfalse };
+			for (auto& set : sets)
+				condition |= set.second.normalize().make_bdd(set.first->var());
+
+			return condition;
+		}
+
+	}
+
+
 	bool is_ip_address(const std::string& addr, IPAddressModel ip_model, bool strict)
 	{
 		switch (ip_model) {
@@ -225,6 +266,15 @@ namespace fwm {
 	}
 
 
+	template<>
+	bdd Group<SrcAddress>::make_bdd() const
+	{
+		return _bdd_cache.get([this]() -> bdd {
+			return make_addresses_bdd(items());
+		});
+	}
+
+
 	bdd SrcAnyAddressGroup::make_bdd() const
 	{
 		return bddtrue;
@@ -382,6 +432,15 @@ namespace fwm {
 	}
 
 
+	template<>
+	bdd Group<DstAddress>::make_bdd() const
+	{
+		return _bdd_cache.get([this]() -> bdd {
+			return make_addresses_bdd(items());
+		});
+	}
+
+
 	bdd DstAnyAddressGroup::make_bdd() const
 	{
 		return bddtrue;
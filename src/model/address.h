@@ -160,6 +160,13 @@ namespace fwm {
 	using SrcAddressGroup = Group<SrcAddress>;
 	using SrcAddressGroupPtr = std::unique_ptr<SrcAddressGroup>;
 
+	/**
+	 * The addresses of a source address group are merged in a sorted list of
+	 * disjoint intervals before building the bdd.
+	*/
+	template<>
+	bdd Group<SrcAddress>::make_bdd() const;
+
 
 	class SrcAnyAddressGroup abstract : public SrcAddressGroup
 	{
@@ -281,6 +288,13 @@ namespace fwm {
 	using DstAddressGroup = Group<DstAddress>;
 	using DstAddressGroupPtr = std::unique_ptr<DstAddressGroup>;
 
+	/**
+	 * The addresses of a destination address group are merged in a sorted list of
+	 * disjoint intervals before building the bdd.
+	*/
+	template<>
+	bdd Group<DstAddress>::make_bdd() const;
+
 
 	class DstAnyAddressGroup abstract : public DstAddressGroup
 	{
@@ -7,21 +7,174 @@
 */
 #include "model/analyzer.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <functional>
 #include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
 #include <utility>
 
 #include "model/domains.h"
 #include "model/gbchandler.h"
 #include "model/state.h"
+#include "model/zone.h"
+#include "tools/process.h"
+#include "fmt/core.h"
 
 
 namespace fwm {
 
+	namespace {
+
+		/* Writes an anomaly to the output stream of a worker.  Rules are
+		 * identified by their position in the acl.
+		*/
+		void write_anomaly(
+			std::ostream& output,
+			const RuleAnomaly& anomaly,
+			const std::unordered_map<const Rule*, size_t>& positions)
+		{
+			const RuleAnomalyDetails& details = anomaly.details();
+			const std::vector<RuleList> related_rules = details.related_rules();
+
+			output
+				<< "A " << positions.at(&anomaly.rule())
+				<< ' ' << static_cast<int>(details.anomaly_scope())
+				<< ' ' << static_cast<int>(details.anomaly_type())
+				<< ' ' << related_rules.size();
+
+			for (const RuleList& rule_list : related_rules) {
+				output << ' ' << rule_list.size();
+				for (const Rule* rule : rule_list)
+					output << ' ' << positions.at(rule);
+			}
+
+			output << '\n';
+		}
+
+
+		/* Reads an anomaly written by a worker.
+		*/
+		std::pair<size_t, RuleAnomalyPtr> read_anomaly(
+			std::istream& input,
+			const std::vector<const Rule*>& rules)
+		{
+			size_t position;
+			int anomaly_scope;
+			int anomaly_type;
+			size_t list_count;
+
+			auto read_position = [&input, &rules]() -> size_t {
+				size_t position;
+				if (!(input >> position) || position >= rules.size())
+					throw std::runtime_error("internal error : invalid worker output");
+				return position;
+			};
+
+			position = read_position();
+			if (!(input >> anomaly_scope >> anomaly_type >> list_count))
+				throw std::runtime_error("internal error : invalid worker output");
+
+			std::vector<RuleList> related_rules;
+			for (size_t list_index = 0; list_index < list_count; list_index++) {
+				size_t rule_count;
+				if (!(input >> rule_count))
+					throw std::runtime_error("internal error : invalid worker output");
+
+				RuleList rule_list(rule_count);
+				for (size_t rule_index = 0; rule_index < rule_count; rule_index++)
+					rule_list.push_back(rules[read_position()]);
+
+				related_rules.push_back(rule_list);
+			}
+
+			RuleAnomalyDetails* details = RuleAnomalyDetails::create(
+				static_cast<RuleAnomalyScope>(anomaly_scope),
+				static_cast<RuleAnomalyType>(anomaly_type),
+				related_rules
+			);
+
+			return std::make_pair(position, RuleAnomalyPtr(new RuleAnomaly(*rules[position], details)));
+		}
+
+
+		/* Writes a bdd to the output stream of a worker.  The nodes are listed
+		 * children first and refer to their children by their index in the
+		 * list, 0 and 1 are the constants.  A worker process is a copy of the
+		 * parent process, the bdd variables are therefore identical.
+		*/
+		void write_bdd(std::ostream& output, const bdd& root)
+		{
+			std::unordered_map<int, size_t> indexes;
+			std::vector<std::tuple<int, size_t, size_t>> nodes;
+
+			std::function<size_t(const bdd&)> add_node = [&](const bdd& node) -> size_t {
+				if (node == bddfalse)
+					return 0;
+				if (node == bddtrue)
+					return 1;
+
+				const auto it = indexes.find(node.id());
+				if (it != indexes.end())
+					return it->second;
+
+				const size_t low = add_node(bdd_low(node));
+				const size_t high = add_node(bdd_high(node));
+				nodes.push_back(std::make_tuple(bdd_var(node), low, high));
+
+				const size_t index = nodes.size() + 1;
+				indexes[node.id()] = index;
+				return index;
+			};
+
+			const size_t root_index = add_node(root);
+			output << root_index << ' ' << nodes.size();
+			for (const auto& node : nodes)
+				output << ' ' << std::get<0>(node) << ' ' << std::get<1>(node) << ' ' << std::get<2>(node);
+			output << '\n';
+		}
+
+
+		/* Reads a bdd written by a worker.
+		*/
+		bdd read_bdd(std::istream& input)
+		{
+			size_t root_index;
+			size_t node_count;
+			if (!(input >> root_index >> node_count))
+				throw std::runtime_error("internal error : invalid worker output");
+
+			std::vector<bdd> nodes{ bddfalse, bddtrue };
+			for (size_t node = 0; node < node_count; node++) {
+				int var;
+				size_t low;
+				size_t high;
+				if (!(input >> var >> low >> high) || var < 0 || var >= bdd_varnum() ||
+					low >= nodes.size() || high >= nodes.size())
+					throw std::runtime_error("internal error : invalid worker output");
+
+				// The children are below the variable of the node, the ite
+				// builds the node without recursion.
+				nodes.push_back(bdd_ite(bdd_ithvar(var), nodes[high], nodes[low]));
+			}
+
+			if (root_index >= nodes.size())
+				throw std::runtime_error("internal error : invalid worker output");
+
+			return nodes[root_index];
+		}
+
+	}
+
+
 	Analyzer::Analyzer(const RuleList& rule_list, IPAddressModel ip_model) :
 		_acl{ rule_list },
-		_ip_model{ ip_model }
+		_ip_model{ ip_model },
+		_profiler{ nullptr },
+		_explanation{ RuleAnomalyExplanation::AllRules },
+		_index{}
 	{
 	}
 
@@ -47,7 +200,7 @@ namespace fwm {
 		PredicatePtr any_predicate = std::unique_ptr<Predicate>(Predicate::any(_ip_model));
 
 		for (const Rule* rule : _acl) {
-			if (rule->action() == RuleAction::DENY && rule->predicate().equal(*any_predicate)) {
+			if (rule->action() == RuleAction::DENY && rule->predicate_bdd().equal(*any_predicate)) {
 				any_rules.push_back(rule);
 			}
 		}
@@ -58,79 +211,553 @@ namespace fwm {
 
 	std::list<RulePair> Analyzer::check_symmetry(bool strict, f_interrupt_cb interrupt_cb) const
 	{
+		Domains& domains = Domains::get();
+		const std::vector<const Rule*> rules{ _acl.begin(), _acl.end() };
+
+		// Bdds are canonical, two rules have the same predicate if the root
+		// nodes of their bdds are identical.  Rules are grouped by action and
+		// by root node.
+		struct RuleKey {
+			RuleAction action;
+			int root;
+
+			bool operator==(const RuleKey& other) const {
+				return action == other.action && root == other.root;
+			}
+		};
+
+		struct RuleKeyHash {
+			size_t operator()(const RuleKey& key) const {
+				return std::hash<int>()(key.root) * 31 + static_cast<size_t>(key.action);
+			}
+		};
+
+		std::unordered_map<RuleKey, std::vector<size_t>, RuleKeyHash> buckets;
+		buckets.reserve(rules.size());
+		for (size_t position = 0; position < rules.size(); position++) {
+			const Rule* rule = rules[position];
+
+			Profiler::Scope scope(_profiler, Profiler::Phase::MakeBdd);
+			buckets[RuleKey{ rule->action(), rule->predicate_bdd().make_bdd().id() }].push_back(position);
+		}
+
+		// The symmetrical bdd of a rule is obtained by swapping the source and
+		// the destination variables of its zone and address bdds.  Rules share
+		// most of their zones and addresses, the swapped bdds are memoized by
+		// root node.  The memo keeps the original bdds alive so that their root
+		// nodes are not reused, the symmetrical bdds are kept alive until the
+		// end of the search for the same reason.
+		std::unordered_map<int, std::pair<bdd, bdd>> swapped_bdds;
+		const auto swap = [&domains, &swapped_bdds](const bdd& b) -> bdd {
+			auto it = swapped_bdds.find(b.id());
+			if (it == swapped_bdds.end())
+				it = swapped_bdds.insert(std::make_pair(b.id(), std::make_pair(b, domains.swap_src_dst(b)))).first;
+
+			return it->second.second;
+		};
+
+		std::vector<std::pair<size_t, size_t>> pairs;
+		std::vector<bdd> symmetrical_bdds;
+		symmetrical_bdds.reserve(rules.size());
+
+		for (size_t position = 0; position < rules.size(); position++) {
+			if (interrupt_cb())
+				throw interrupt_error("** interrupted **");
+
+			const Rule* rule = rules[position];
+			{
+				Profiler::Scope scope(_profiler, Profiler::Phase::SwapSrcDst);
+				symmetrical_bdds.push_back(rule->predicate().make_symmetrical_bdd(swap));
+			}
+
+			// two rules are symmetrical if the action and the predicates are identical
+			auto it = buckets.find(RuleKey{ rule->action(), symmetrical_bdds.back().id() });
+			if (it != buckets.end()) {
+				for (const size_t other_position : it->second) {
+					if (other_position >= position)
+						break;
+
+					pairs.push_back(std::make_pair(other_position, position));
+				}
+			}
+		}
+
+		// Report the pairs in the order of the rule list.
+		std::sort(pairs.begin(), pairs.end());
+
 		std::list<RulePair> symmetrical_rules;
+		for (const auto& pair : pairs)
+			symmetrical_rules.push_back(std::make_tuple(rules[pair.first], rules[pair.second]));
+
+		return symmetrical_rules;
+	}
+
+
+	std::list<RuleList> Analyzer::check_duplicate(f_interrupt_cb interrupt_cb) const
+	{
+		return find_duplicates(
+			[](const Rule& rule) -> const Bddnode& { return rule.predicate_bdd(); },
+			interrupt_cb
+		);
+	}
+
+
+	std::list<RuleList> Analyzer::check_duplicate(const Predicate::BddOptions& options, f_interrupt_cb interrupt_cb) const
+	{
+		return find_duplicates(
+			[&options](const Rule& rule) -> const Bddnode& { return rule.predicate_bdd(options); },
+			interrupt_cb
+		);
+	}
+
 
-		// this cache contains bdd of symmetrical predicates.
-		Bddcache cache{};
-		cache.reserve(_acl.size());
+	std::list<RuleList> Analyzer::find_duplicates(f_rule_bdd rule_bdd, f_interrupt_cb interrupt_cb) const
+	{
+		// Bdds are canonical, two rules have the same predicate if the root
+		// nodes of their bdds are identical.  Rules are grouped by action and
+		// by root node in a single pass.
+		using RuleKey = std::pair<RuleAction, int>;
+
+		struct RuleKeyHash {
+			size_t operator()(const RuleKey& key) const {
+				return std::hash<int>()(key.second) * 31 + static_cast<size_t>(key.first);
+			}
+		};
+
+		std::unordered_map<RuleKey, size_t, RuleKeyHash> group_positions;
+		std::vector<RuleList> groups;
 
-		int rule_index{ 0 };
 		for (const Rule* rule : _acl) {
-			auto it = _acl.begin();
-			std::advance(it, ++rule_index);
-
-			for (; it != _acl.end(); ++it) {
-				const Rule* other_rule = *it;
-				Bddnode symmetrical_bdd;
-
-				auto pos = cache.find(other_rule->id());
-				if (pos == cache.end()) {
-					const PredicatePtr other_predicate{ other_rule->predicate().symmetrical() };
-					symmetrical_bdd = other_predicate->make_bdd();
-					cache[other_rule->id()] = symmetrical_bdd;
+			if (interrupt_cb())
+				throw interrupt_error("** interrupted **");
+
+			Profiler::Scope scope(_profiler, Profiler::Phase::MakeBdd);
+			const RuleKey key{ rule->action(), rule_bdd(*rule).make_bdd().id() };
+
+			auto it = group_positions.find(key);
+			if (it == group_positions.end()) {
+				group_positions[key] = groups.size();
+				groups.push_back(RuleList());
+				groups.back().push_back(rule);
+			}
+			else {
+				groups[it->second].push_back(rule);
+			}
+		}
+
+		// Keep the groups having more than one rule.
+		std::list<RuleList> duplicate_rules;
+		for (const RuleList& group : groups) {
+			if (group.size() > 1)
+				duplicate_rules.push_back(group);
+		}
+
+		return duplicate_rules;
+	}
+
+
+	RuleAnomalies Analyzer::check_anomaly(f_interrupt_cb interrupt_cb) const
+	{
+		return find_anomalies(nullptr, nullptr, _acl.size() > 20, interrupt_cb);
+	}
+
+
+	RuleAnomalies Analyzer::check_anomaly(AnomalyCache& cache, f_interrupt_cb interrupt_cb) const
+	{
+		return find_anomalies(&cache, nullptr, _acl.size() > 20, interrupt_cb);
+	}
+
+
+	void Analyzer::check_anomaly(RuleAnomalySink& sink, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const
+	{
+		const RuleAnomalies anomalies = find_anomalies(cache, &sink, _acl.size() > 20, interrupt_cb);
+		sink.missing_deny_all = anomalies.missing_deny_all;
+	}
+
+
+	RuleAnomalies Analyzer::check_anomaly(int jobs, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const
+	{
+		return find_anomalies(jobs, cache, nullptr, interrupt_cb);
+	}
+
+
+	void Analyzer::check_anomaly(int jobs, RuleAnomalySink& sink, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const
+	{
+		const RuleAnomalies anomalies = find_anomalies(jobs, cache, &sink, interrupt_cb);
+		sink.missing_deny_all = anomalies.missing_deny_all;
+	}
+
+
+	RuleAnomalies Analyzer::find_anomalies(int jobs, AnomalyCache* cache, RuleAnomalySink* sink, f_interrupt_cb interrupt_cb) const
+	{
+		const std::vector<RuleList> slices = partition();
+
+		// Position of the rules in the acl, used to exchange the results with
+		// the worker processes.
+		std::vector<const Rule*> rules{ _acl.begin(), _acl.end() };
+
+		bool serial = jobs <= 1 || slices.size() <= 1;
+		if (cache && !serial) {
+			// The incremental analysis restarts from the nearest checkpoint, it is
+			// faster when less rules follow the checkpoint than the share of a
+			// worker.
+			cache->set_explanation(_explanation);
+			const size_t checkpoint_position = cache->checkpoint_position(cache->prefix_size(rules));
+			serial = checkpoint_position != AnomalyCache::npos &&
+				rules.size() - checkpoint_position <= rules.size() / jobs;
+		}
+
+		if (serial)
+			return find_anomalies(cache, sink, rules.size() > 20, interrupt_cb);
+
+		std::unordered_map<const Rule*, size_t> positions;
+		for (size_t position = 0; position < rules.size(); position++)
+			positions[rules[position]] = position;
+
+		// Distribute the slices between the workers, largest slices first.
+		std::vector<size_t> order(slices.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&slices](size_t s1, size_t s2) -> bool {
+			return slices[s1].size() > slices[s2].size();
+		});
+
+		const size_t worker_count = std::min(static_cast<size_t>(jobs), slices.size());
+		std::vector<std::vector<const RuleList*>> workloads(worker_count);
+		std::vector<size_t> workload_sizes(worker_count, 0);
+		for (const size_t slice : order) {
+			const size_t worker = std::distance(
+				workload_sizes.begin(),
+				std::min_element(workload_sizes.begin(), workload_sizes.end())
+			);
+
+			workloads[worker].push_back(&slices[slice]);
+			workload_sizes[worker] += slices[slice].size();
+		}
+
+		PredicatePtr any_predicate = std::unique_ptr<Predicate>(Predicate::any(_ip_model));
+
+		std::vector<rat::f_task> tasks;
+		for (const auto& workload : workloads) {
+			tasks.push_back([this, &workload, &positions, &any_predicate, interrupt_cb]() -> std::string {
+				std::ostringstream output;
+
+				Profiler profiler;
+				if (_profiler)
+					profiler.start();
+
+				// The part of the initial state not covered by the rules of the
+				// worker, a deny all rule is missing if no worker covers it.
+				bdd uncovered = any_predicate->make_bdd();
+
+				for (const RuleList* slice : workload) {
+					Analyzer analyzer{ *slice, _ip_model };
+					analyzer.set_explanation(_explanation);
+					analyzer.set_profiler(_profiler ? &profiler : nullptr);
+					const RuleAnomalies anomalies = analyzer.find_anomalies(nullptr, nullptr, false, interrupt_cb);
+
+					for (const Rule* rule : *slice) {
+						const bdd rule_bdd = rule->predicate_bdd().make_bdd();
+
+						// A rule with an empty predicate is a subset of all rules and
+						// belongs to the anomaly details of rules from other slices.
+						if (rule_bdd == bddfalse)
+							return "E\n";
+
+						uncovered -= rule_bdd;
+					}
+
+					for (const RuleAnomalyPtr& anomaly : anomalies)
+						write_anomaly(output, *anomaly, positions);
 				}
-				else {
-					symmetrical_bdd = pos->second;
+
+				output << "C ";
+				write_bdd(output, uncovered);
+
+				if (_profiler) {
+					profiler.stop();
+					output << "P ";
+					profiler.write_counters(output);
+					output << '\n';
+				}
+
+				return output.str();
+			});
+		}
+
+		const std::vector<std::string> results = rat::run_tasks(tasks, interrupt_cb);
+
+		std::vector<std::pair<size_t, RuleAnomalyPtr>> merged;
+		bdd uncovered = any_predicate->make_bdd();
+		for (const std::string& result : results) {
+			std::istringstream input{ result };
+			std::string tag;
+
+			while (input >> tag) {
+				if (tag == "E") {
+					// Fall back to the serial analysis.
+					return find_anomalies(cache, sink, rules.size() > 20, interrupt_cb);
 				}
+				else if (tag == "A")
+					merged.push_back(read_anomaly(input, rules));
+				else if (tag == "C")
+					uncovered &= read_bdd(input);
+				else if (tag == "P" && _profiler)
+					_profiler->merge_counters(input);
+				else
+					throw std::runtime_error("internal error : invalid worker output");
+			}
+		}
 
+		// Merge the anomalies in the acl order.
+		std::sort(merged.begin(), merged.end(),
+			[](const std::pair<size_t, RuleAnomalyPtr>& a1, const std::pair<size_t, RuleAnomalyPtr>& a2) -> bool {
+				return a1.first < a2.first;
+			});
+
+		if (cache) {
+			// Record the result of each rule, the next analysis replays the
+			// state updates from the initial state.
+			cache->clear();
+			cache->add_checkpoint(State{ *any_predicate });
+
+			auto it = merged.begin();
+			for (size_t position = 0; position < rules.size(); position++) {
+				const bool has_anomaly = it != merged.end() && it->first == position;
+				cache->add_result(rules[position], has_anomaly ? (it++)->second.get() : nullptr);
+			}
+		}
+
+		RuleAnomalies anomalies{};
+		for (auto& item : merged) {
+			if (sink)
+				sink->add(*item.second);
+			else
+				anomalies.push_back(std::move(item.second));
+		}
+
+		// The last deny all rule is not part of the slices.
+		anomalies.missing_deny_all = !_acl.back()->is_deny_all() && uncovered != bddfalse;
+
+		return anomalies;
+	}
+
+
+	RuleAnomalyPtr Analyzer::check_anomaly(const Rule& rule, const AnomalyCache* cache, f_interrupt_cb interrupt_cb) const
+	{
+		const std::vector<const Rule*> rules{ _acl.begin(), _acl.end() };
+		const auto it = std::find(rules.begin(), rules.end(), &rule);
+		if (it == rules.end())
+			throw std::runtime_error(fmt::format("rule id '{}' is not analyzed", rule.id()));
+
+		const size_t position = std::distance(rules.begin(), it);
+
+		// The last deny all rule is not analyzed.
+		if (rule.is_deny_all() && position + 1 == rules.size())
+			return nullptr;
+
+		PredicatePtr any_predicate = std::unique_ptr<Predicate>(Predicate::any(_ip_model));
+		State state{ *any_predicate };
+		size_t start_position = 0;
+
+		if (cache && position < cache->prefix_size(rules)) {
+			// The cached result is reused if it was explained the same way.
+			if (cache->explanation() == _explanation && _explanation != RuleAnomalyExplanation::NoRules)
+				return RuleAnomalyPtr(cache->result(position));
+
+			// The rules preceding this rule did not change, restart from
+			// the nearest checkpoint.
+			const size_t checkpoint_position = cache->checkpoint_position(position);
+			if (checkpoint_position != AnomalyCache::npos) {
+				state = cache->checkpoint(checkpoint_position);
+				start_position = checkpoint_position;
+			}
+		}
+
+		{
+			Profiler::Scope scope(_profiler, Profiler::Phase::StateUpdate);
+			for (size_t index = start_position; index < position; index++) {
 				if (interrupt_cb())
 					throw interrupt_error("** interrupted **");
 
-				// two rules are symmetrical if the action and the predicates are identical
-				if (rule->action() == other_rule->action() && rule->predicate().equal(symmetrical_bdd)) {
-					symmetrical_rules.push_back(std::make_tuple(rule, other_rule));
+				state.update(rules[index]->action(), rules[index]->predicate_bdd());
+			}
+		}
+
+		Profiler::Scope scope(_profiler, Profiler::Phase::CheckRule);
+		return RuleAnomalyPtr(check_rule(rule, state));
+	}
+
+
+	std::vector<RuleList> Analyzer::partition() const
+	{
+		std::vector<RuleList> slices;
+		if (_acl.size() == 0)
+			return slices;
+
+		// The last deny all rule is not checked and does not precede any rule.
+		const Rule* deny_all_rule = _acl.back()->is_deny_all() ? _acl.back() : nullptr;
+
+		const SrcZoneListPtr src_zones = _acl.all_src_zones();
+		const DstZoneListPtr dst_zones = _acl.all_dst_zones();
+
+		std::vector<const Rule*> rules;
+		for (const Rule* rule : _acl) {
+			if (rule != deny_all_rule)
+				rules.push_back(rule);
+		}
+
+		// Union-find structure used to group the rules.
+		std::vector<size_t> parents(rules.size());
+		std::iota(parents.begin(), parents.end(), 0);
+
+		std::function<size_t(size_t)> find_root = [&parents](size_t index) -> size_t {
+			while (parents[index] != index) {
+				parents[index] = parents[parents[index]];
+				index = parents[index];
+			}
+			return index;
+		};
+
+		// The first rule found in each zone pair.
+		const size_t no_rule = rules.size();
+		std::vector<size_t> pair_owners(src_zones->size() * dst_zones->size(), no_rule);
+
+		for (size_t index = 0; index < rules.size(); index++) {
+			const Predicate& predicate = rules[index]->predicate();
+
+			// Same selection as in RuleList::filter(const ZonePair&).
+			std::vector<size_t> src_indexes;
+			size_t src_index = 0;
+			for (const SrcZone* src_zone : *src_zones) {
+				if (src_zone->is_subset(predicate.src_zones()))
+					src_indexes.push_back(src_index);
+				src_index++;
+			}
+
+			std::vector<size_t> dst_indexes;
+			size_t dst_index = 0;
+			for (const DstZone* dst_zone : *dst_zones) {
+				if (dst_zone->is_subset(predicate.dst_zones()))
+					dst_indexes.push_back(dst_index);
+				dst_index++;
+			}
+
+			for (const size_t s : src_indexes) {
+				for (const size_t d : dst_indexes) {
+					size_t& owner = pair_owners[s * dst_zones->size() + d];
+					if (owner == no_rule)
+						owner = index;
+					else
+						parents[find_root(index)] = find_root(owner);
 				}
 			}
 		}
 
-		return symmetrical_rules;
+		// Build the slices.
+		std::unordered_map<size_t, size_t> slice_indexes;
+		for (size_t index = 0; index < rules.size(); index++) {
+			const size_t root = find_root(index);
+
+			auto it = slice_indexes.find(root);
+			if (it == slice_indexes.end()) {
+				it = slice_indexes.insert(std::make_pair(root, slices.size())).first;
+				slices.push_back(RuleList());
+			}
+
+			slices[it->second].push_back(rules[index]);
+		}
+
+		return slices;
 	}
 
 
-	RuleAnomalies Analyzer::check_anomaly(f_interrupt_cb interrupt_cb) const
+	RuleAnomalies Analyzer::find_anomalies(AnomalyCache* cache, RuleAnomalySink* sink, bool show_progress, f_interrupt_cb interrupt_cb) const
 	{
 		RuleAnomalies anomalies{};
 
+		// The anomalies are written to the sink or kept in the list.
+		auto add_anomaly = [&anomalies, sink](RuleAnomaly* anomaly) {
+			RuleAnomalyPtr anomaly_ptr{ anomaly };
+			if (sink)
+				sink->add(*anomaly_ptr);
+			else
+				anomalies.push_back(std::move(anomaly_ptr));
+		};
+
 		// Initial state is configured to accept any packets
 		PredicatePtr any_predicate = std::unique_ptr<Predicate>(Predicate::any(_ip_model));
 		State state{ *any_predicate };
 
-		// The bdd cache is used when searching for preceding rules that are
-		// involved in an anomaly.  It avoids to rebuild the bdd over and over.
-		Bddcache cache{};
-		cache.reserve(_acl.size());
+		const std::vector<const Rule*> rules{ _acl.begin(), _acl.end() };
+		size_t position = 0;
+
+		if (_profiler) {
+			// Build the bdd of all rules before the analysis to measure the
+			// time spent in this phase.
+			Profiler::Scope scope(_profiler, Profiler::Phase::MakeBdd);
+			for (const Rule* rule : rules)
+				rule->predicate_bdd();
+		}
+
+		if (cache) {
+			// Reuse the results of the leading rules that did not change since
+			// the previous analysis.
+			cache->set_explanation(_explanation);
+			const size_t prefix_size = cache->prefix_size(rules);
+			cache->truncate(prefix_size);
+
+			const size_t checkpoint_position = cache->checkpoint_position(prefix_size);
+			if (checkpoint_position != AnomalyCache::npos) {
+				for (; position < prefix_size; position++) {
+					RuleAnomaly* anomaly = cache->result(position);
+					if (anomaly)
+						add_anomaly(anomaly);
+				}
+
+				// Restart from the nearest checkpoint and replay the state updates
+				// up to the first rule to analyze.
+				state = cache->checkpoint(checkpoint_position);
+				Profiler::Scope scope(_profiler, Profiler::Phase::StateUpdate);
+				for (size_t index = checkpoint_position; index < prefix_size; index++)
+					state.update(rules[index]->action(), rules[index]->predicate_bdd());
+			}
+			else {
+				cache->clear();
+			}
+		}
 
 		// Initialize the progress bar.
-		bool show_progress = _acl.size() > 20;
 		int loop_counter = 0;
 		GbcHandler gbc_handler(show_progress);
 
-		for (const Rule* rule : _acl) {
+		for (; position < rules.size(); position++) {
+			const Rule* rule = rules[position];
+
 			if (interrupt_cb())
 				throw interrupt_error("** interrupted **");
 
-			// Compute the bdd of the current rule and add it to the local cache.
-			cache[rule->id()] = Bddnode{ rule->predicate().make_bdd() };
+			if (cache)
+				cache->add_checkpoint(state);
 
-			if (!(rule->is_deny_all() && _acl.is_last(rule))) {
+			RuleAnomaly* anomaly = nullptr;
+			if (!(rule->is_deny_all() && position + 1 == rules.size())) {
 				// Check for anomalies.
-				RuleAnomaly* anomaly = check_rule(*rule, state, cache);
-				if (anomaly)
-					anomalies.push_back(std::unique_ptr<RuleAnomaly>(anomaly));
+				Profiler::Scope scope(_profiler, Profiler::Phase::CheckRule);
+				anomaly = check_rule(*rule, state);
 			}
 
-			// Update the state of the analyzer.
-			state.update(rule->action(), cache.at(rule->id()));
+			if (cache)
+				cache->add_result(rule, anomaly);
+
+			if (anomaly)
+				add_anomaly(anomaly);
+
+			// Update the state of the analyzer.  The bdd of the rule is retrieved
+			// from the firewall bdd store.
+			{
+				Profiler::Scope scope(_profiler, Profiler::Phase::StateUpdate);
+				state.update(rule->action(), rule->predicate_bdd());
+			}
 
 			if (show_progress) {
 				// Show progress
@@ -152,12 +779,12 @@ namespace fwm {
 	}
 
 
-	RuleAnomaly* Analyzer::check_rule(const Rule& rule, const State& state, const Bddcache& cache) const
+	RuleAnomaly* Analyzer::check_rule(const Rule& rule, const State& state) const
 	{
 		RuleAnomalyDetails* anomaly_details;
 
 		// Compare the rule with the set of remaining potential packets.
-		const Bddnode& predicate_bdd = cache.at(rule.id());
+		const Bddnode& predicate_bdd = rule.predicate_bdd();
 		if (predicate_bdd.is_subset(state.remaining())) {
 			/*               This is a good rule               */
 			/***************************************************/
@@ -166,44 +793,52 @@ namespace fwm {
 		else if (state.remaining().is_none() || predicate_bdd.is_disjoint(state.remaining())) {
 			/*               This is a fully masked rule       */
 			/***************************************************/
-			anomaly_details = analyze_fully_masked_rule(rule, state, cache);
+			anomaly_details = analyze_fully_masked_rule(rule, state);
 		}
 		else {
 			/*               This is a partially masked rule   */
 			/***************************************************/
-			anomaly_details = analyze_partially_masked_rule(rule, state, cache);
+			anomaly_details = analyze_partially_masked_rule(rule, state);
 		}
 
 		return anomaly_details ? new RuleAnomaly(rule, anomaly_details) : nullptr;
 	}
 
 
-	RuleAnomalyDetails* Analyzer::analyze_fully_masked_rule(const Rule& rule, const State& state, const Bddcache& cache) const
+	RuleAnomalyDetails* Analyzer::analyze_fully_masked_rule(const Rule& rule, const State& state) const
 	{
-		const Bddnode& predicate_bdd = cache.at(rule.id());
+		const Bddnode& predicate_bdd = rule.predicate_bdd();
 
 		if (predicate_bdd.is_subset(state.processed(!rule.action()))) {
 			// Shadowed by preceding deny(/allow) rules. Find a deny(/allow) rule
 			// that completely hides this rule or a combination of deny(/allow) rules
 			// that globally hide this rule.
-			return new RuleAnomalyShadowed(find_overlaping(rule, !rule.action(), cache));
+			return new RuleAnomalyShadowed(explain(rule, !rule.action(), predicate_bdd.make_bdd()));
 		}
 
 		if (predicate_bdd.is_disjoint(state.processed(!rule.action()))) {
 			// Redundant by preceding allow(/deny) rules.
-			return new RuleAnomalyFullRedundant(find_overlaping(rule, rule.action(), cache));
+			return new RuleAnomalyFullRedundant(explain(rule, rule.action(), predicate_bdd.make_bdd()));
 		}
 
 		// Redundant or correlated rules.
 
 		// Part of the packets intended to be accepted by this rule have been
 		// denied(/allowed) by preceding rules.
-		RuleList correlated_rules = find_overlaping(rule, !rule.action(), cache);
+		RuleList correlated_rules = explain(
+			rule,
+			!rule.action(),
+			predicate_bdd.make_bdd() & state.processed(!rule.action()).make_bdd()
+		);
 
 		// Other packets have been accepted.
 		// Find an allow(/deny) rule that completely hides this rule or a
 		// a combination of allow(/deny) rules that globally hide this rule.
-		RuleList redundant_rules = find_overlaping(rule, rule.action(), cache);
+		RuleList redundant_rules = explain(
+			rule,
+			rule.action(),
+			predicate_bdd.make_bdd() & state.processed(rule.action()).make_bdd()
+		);
 
 		return new RuleAnomalyRedundantOrCorrelated(
 				redundant_rules,
@@ -212,19 +847,22 @@ namespace fwm {
 	};
 
 
-	RuleAnomalyDetails* Analyzer::analyze_partially_masked_rule(const Rule& rule, const State& state, const Bddcache& cache) const
+	RuleAnomalyDetails* Analyzer::analyze_partially_masked_rule(const Rule& rule, const State& state) const
 	{
-		const Bddnode& predicate_bdd = cache.at(rule.id());
+		if (_explanation == RuleAnomalyExplanation::NoRules)
+			return classify_partially_masked_rule(rule, state);
+
+		const Bddnode& predicate_bdd = rule.predicate_bdd();
 
 		// Search for a generalization rule
-		RuleList matching_rules = find_other_is_subset(rule, !rule.action(), cache);
+		RuleList matching_rules = find_other_is_subset(rule, !rule.action());
 		if (matching_rules.size() > 0) {
 			return new RuleAnomalyGeneralization(matching_rules);
 		}
 
 		// Search for redundancy
 		if (predicate_bdd.overlaps(state.processed(rule.action()))) {
-			matching_rules = find_other_is_subset(rule, rule.action(), cache);
+			matching_rules = find_other_is_subset(rule, rule.action());
 			if (matching_rules.size() > 0) {
 				return new RuleAnomalyPartialRedundant(matching_rules);
 			}
@@ -232,7 +870,7 @@ namespace fwm {
 
 		// Search for a correlated rule
 		if (predicate_bdd.overlaps(state.processed(!rule.action()))) {
-			matching_rules = find_overlaping(rule, !rule.action(), cache);
+			matching_rules = find_overlaping(rule, !rule.action());
 			if (matching_rules.size() > 0) {
 				return new RuleAnomalyCorrelated(matching_rules);
 			}
@@ -242,39 +880,173 @@ namespace fwm {
 	}
 
 
-	RuleList Analyzer::find_is_subset(const Rule& rule, RuleAction action, const Bddcache& cache) const
+	RuleAnomalyDetails* Analyzer::classify_partially_masked_rule(const Rule& rule, const State& state) const
+	{
+		const Bddnode& predicate_bdd = rule.predicate_bdd();
+
+		// Same classification as analyze_partially_masked_rule, the searches
+		// stop at the first related rule and no rule is reported.  The state
+		// only holds the union of the preceding rules and cannot tell whether
+		// a single rule is a subset of this rule : the subset tests still scan
+		// the candidates of the rule index, up to two scans of all preceding
+		// rules when no candidate matches.
+		if (has_other_is_subset(rule, !rule.action()))
+			return new RuleAnomalyGeneralization(RuleList());
+
+		if (predicate_bdd.overlaps(state.processed(rule.action())) && has_other_is_subset(rule, rule.action()))
+			return new RuleAnomalyPartialRedundant(RuleList());
+
+		// A preceding rule overlaps this rule when the processed packets
+		// overlap this rule.
+		if (predicate_bdd.overlaps(state.processed(!rule.action())))
+			return new RuleAnomalyCorrelated(RuleList());
+
+		return nullptr;
+	}
+
+
+	const RuleIndex& Analyzer::index() const
+	{
+		if (!_index)
+			_index.reset(new RuleIndex(_acl));
+
+		return *_index;
+	}
+
+
+	RuleList Analyzer::find_is_subset(const Rule& rule, RuleAction action) const
 	{
-		const Bddnode& predicate_bdd{ cache.at(rule.id()) };
+		Profiler::Scope scope(_profiler, Profiler::Phase::FindIsSubset);
+		const Bddnode& predicate_bdd{ rule.predicate_bdd() };
 
-		auto select_func = [action, &predicate_bdd, cache](const Rule& other) -> bool {
-			return other.action() == action && predicate_bdd.is_subset(cache.at(other.id()));
+		auto select_func = [action, &predicate_bdd](const Rule& other) -> bool {
+			return other.action() == action && predicate_bdd.is_subset(other.predicate_bdd());
 		};
 
-		return _acl.filter_before(&rule, select_func);
+		// An empty predicate is a subset of all predicates.
+		if (predicate_bdd.is_none())
+			return _acl.filter_before(&rule, select_func);
+
+		return index().candidates(rule, false).filter(select_func);
 	};
 
 
-	RuleList Analyzer::find_other_is_subset(const Rule& rule, RuleAction action, const Bddcache& cache) const
+	RuleList Analyzer::find_other_is_subset(const Rule& rule, RuleAction action) const
 	{
-		const Bddnode& predicate_bdd{ cache.at(rule.id()) };
+		Profiler::Scope scope(_profiler, Profiler::Phase::FindOtherIsSubset);
+		const Bddnode& predicate_bdd{ rule.predicate_bdd() };
 
-		auto select_func = [action, &predicate_bdd, cache](const Rule& other) -> bool {
-			return other.action() == action && cache.at(other.id()).is_subset(predicate_bdd);
+		auto select_func = [action, &predicate_bdd](const Rule& other) -> bool {
+			return other.action() == action && other.predicate_bdd().is_subset(predicate_bdd);
 		};
 
-		return _acl.filter_before(&rule, select_func);
+		// Preceding rules having an empty predicate are a subset of this rule.
+		return index().candidates(rule, true).filter(select_func);
+	}
+
+
+	bool Analyzer::has_other_is_subset(const Rule& rule, RuleAction action) const
+	{
+		Profiler::Scope scope(_profiler, Profiler::Phase::FindOtherIsSubset);
+		const Bddnode& predicate_bdd{ rule.predicate_bdd() };
+
+		for (const Rule* other : index().candidates(rule, true)) {
+			if (other->action() == action && other->predicate_bdd().is_subset(predicate_bdd))
+				return true;
+		}
+
+		return false;
 	}
 
 
-	RuleList Analyzer::find_overlaping(const Rule& rule, RuleAction action, const Bddcache& cache) const
+	RuleList Analyzer::find_overlaping(const Rule& rule, RuleAction action) const
 	{
-		const Bddnode& predicate_bdd{ cache.at(rule.id()) };
+		Profiler::Scope scope(_profiler, Profiler::Phase::FindOverlapping);
+		const Bddnode& predicate_bdd{ rule.predicate_bdd() };
 
-		auto select_func = [action, &predicate_bdd, cache](const Rule& other) -> bool {
-			return other.action() == action && predicate_bdd.overlaps(cache.at(other.id()));
+		auto select_func = [action, &predicate_bdd](const Rule& other) -> bool {
+			return other.action() == action && predicate_bdd.overlaps(other.predicate_bdd());
 		};
 
-		return _acl.filter_before(&rule, select_func);
+		return index().candidates(rule, false).filter(select_func);
+	}
+
+
+
+	RuleList Analyzer::find_covering(const Rule& rule, RuleAction action, const bdd& target) const
+	{
+		Profiler::Scope scope(_profiler, Profiler::Phase::FindCovering);
+
+		// Candidates are visited from the nearest preceding rule.
+		const RuleList candidate_list = index().candidates(rule, false);
+		const std::vector<const Rule*> candidates{ candidate_list.begin(), candidate_list.end() };
+		std::vector<const Rule*> selected;
+		std::vector<bdd> overlaps;
+		bdd covered = bddfalse;
+
+		for (size_t position = candidates.size(); position-- > 0 && covered != target; ) {
+			const Rule* other = candidates[position];
+			if (other->action() != action)
+				continue;
+
+			const bdd overlap = target & other->predicate_bdd().make_bdd();
+			if (overlap == bddfalse)
+				continue;
+
+			if (overlap == target) {
+				// This rule alone contains the target.
+				RuleList rules(1);
+				rules.push_back(other);
+				return rules;
+			}
+
+			if (!bdd_subset(overlap, covered)) {
+				selected.push_back(other);
+				overlaps.push_back(overlap);
+				covered |= overlap;
+			}
+		}
+
+		// Remove the rules made useless by the other rules, starting with the
+		// nearest rules that often contribute the least.  A rule is tested
+		// against the rules kept before it and all the rules after it, the
+		// unions of the rules after each rule are computed once.
+		std::vector<bdd> suffixes(selected.size() + 1, bddfalse);
+		for (size_t index = selected.size(); index-- > 0; )
+			suffixes[index] = suffixes[index + 1] | overlaps[index];
+
+		std::vector<bool> removed(selected.size(), false);
+		bdd kept = bddfalse;
+		for (size_t index = 0; index < selected.size() && selected.size() > 1; index++) {
+			if (bdd_subset(target, kept | suffixes[index + 1]))
+				removed[index] = true;
+			else
+				kept |= overlaps[index];
+		}
+
+		// Return the rules in the acl order.
+		RuleList rules(selected.size());
+		for (size_t index = selected.size(); index-- > 0; ) {
+			if (!removed[index])
+				rules.push_back(selected[index]);
+		}
+
+		return rules;
+	}
+
+
+	RuleList Analyzer::explain(const Rule& rule, RuleAction action, const bdd& target) const
+	{
+		switch (_explanation) {
+		case RuleAnomalyExplanation::MinimalRules:
+			return find_covering(rule, action, target);
+
+		case RuleAnomalyExplanation::NoRules:
+			return RuleList();
+
+		default:
+			return find_overlaping(rule, action);
+		}
 	}
 
 }
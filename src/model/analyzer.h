@@ -8,14 +8,21 @@
 #pragma once
 #include "global.h"
 
+#include <functional>
 #include <list>
+#include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include "model/anomaly.h"
+#include "model/anomalysink.h"
+#include "model/anomalycache.h"
 #include "model/ipaddress.h"
 #include "model/rulelist.h"
+#include "model/ruleindex.h"
 #include "model/predicate.h"
+#include "model/profiler.h"
 #include "model/state.h"
 #include "tools/interrupt.h"
 
@@ -27,38 +34,136 @@ namespace fwm {
 	class Analyzer
 	{
 	public:
-		using Bddcache = std::unordered_map<int, Bddnode>;
-
 		Analyzer(const RuleList& rule_list, IPAddressModel ip_model);
 
 		RuleList check_any(const DstAddressGroup& any_addresses) const;
 		RuleList check_deny() const;
 		std::list<RulePair> check_symmetry(bool strict, f_interrupt_cb interrupt_cb) const;
+
+		/* Searches for groups of duplicate rules.  Rules of a group have the same
+		 * action and the same predicate.  Groups are ordered by their first rule
+		 * and rules of a group are in the acl order.
+		*/
+		std::list<RuleList> check_duplicate(f_interrupt_cb interrupt_cb) const;
+
+		/* Searches for groups of duplicate rules where the predicates are
+		 * compared using only the criteria selected in the options.
+		*/
+		std::list<RuleList> check_duplicate(const Predicate::BddOptions& options, f_interrupt_cb interrupt_cb) const;
+
 		RuleAnomalies check_anomaly(f_interrupt_cb interrupt_cb) const;
 
+		/* Searches for anomalies and reuses the results of a previous analysis
+		 * kept in the cache.  The analysis restarts from the nearest checkpoint
+		 * before the first rule that changed since the previous analysis.  The
+		 * cache is updated with the new results.
+		*/
+		RuleAnomalies check_anomaly(AnomalyCache& cache, f_interrupt_cb interrupt_cb) const;
+
+		/* Searches for anomalies and writes each anomaly to the sink as soon as
+		 * it is found.  The anomalies are not kept in memory, except in the
+		 * optional cache.
+		*/
+		void check_anomaly(RuleAnomalySink& sink, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const;
+
+		/* Searches for anomalies using 'jobs' worker processes.  The rules are
+		 * partitioned into independent slices that are analyzed concurrently.
+		 * The result is identical to the result of the serial analysis.  The
+		 * counters measured by the workers are added to the profiler.
+		 *
+		 * The optional cache receives the merged results.  When the incremental
+		 * analysis restarts from a checkpoint followed by fewer rules than the
+		 * share of a worker, it is used instead of the workers.
+		*/
+		RuleAnomalies check_anomaly(int jobs, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const;
+
+		/* Searches for anomalies using 'jobs' worker processes and writes them
+		 * to the sink in the acl order once all workers are done.
+		*/
+		void check_anomaly(int jobs, RuleAnomalySink& sink, AnomalyCache* cache, f_interrupt_cb interrupt_cb) const;
+
+		/* Analyzes a single rule of the acl.  The state of the analyzer before
+		 * this rule is rebuilt from the nearest checkpoint of the optional cache
+		 * or from the first rule.  The function returns a null pointer if the
+		 * rule has no anomaly and throws a runtime_error if the rule is not in
+		 * the acl.
+		*/
+		RuleAnomalyPtr check_anomaly(const Rule& rule, const AnomalyCache* cache, f_interrupt_cb interrupt_cb) const;
+
+		/* Partitions the rules into independent slices.  Two rules belong to the
+		 * same slice when their source zones and their destination zones overlap.
+		 * A slice is built from the zone pairs returned by RuleList::filter(ZonePair)
+		 * that share at least one rule.  The last rule is excluded when it is a
+		 * deny all rule.  Rules of a slice are in the acl order and slices are
+		 * ordered by their first rule.
+		*/
+		std::vector<RuleList> partition() const;
+
 		inline const RuleList& acl() const noexcept { return _acl; }
 
+		/* Sets the profiler measuring the phases of the analysis.  The
+		 * profiler is not used when null.
+		*/
+		inline void set_profiler(Profiler* profiler) noexcept { _profiler = profiler; }
+
+		/* Selects the rules reported in the details of a fully masked rule.  By
+		 * default, all preceding rules overlapping the rule are reported.
+		*/
+		inline void set_explanation(RuleAnomalyExplanation explanation) noexcept { _explanation = explanation; }
+		inline RuleAnomalyExplanation explanation() const noexcept { return _explanation; }
+
 	private:
 		const RuleList _acl;
 		const IPAddressModel _ip_model;
+		Profiler* _profiler;
+		RuleAnomalyExplanation _explanation;
+
+		// The candidate index used when searching for rules involved in an
+		// anomaly.  The index is built on first use.
+		mutable std::unique_ptr<RuleIndex> _index;
+		const RuleIndex& index() const;
 
-		RuleAnomaly* check_rule(const Rule& rule, const State& state, const Bddcache& cache) const;
-		RuleAnomalyDetails* analyze_fully_masked_rule(const Rule& rule, const State& state, const Bddcache& cache) const;
-		RuleAnomalyDetails* analyze_partially_masked_rule(const Rule& rule, const State& state, const Bddcache& cache) const;
+		using f_rule_bdd = std::function<const Bddnode&(const Rule&)>;
+		std::list<RuleList> find_duplicates(f_rule_bdd rule_bdd, f_interrupt_cb interrupt_cb) const;
+
+		RuleAnomalies find_anomalies(AnomalyCache* cache, RuleAnomalySink* sink, bool show_progress, f_interrupt_cb interrupt_cb) const;
+		RuleAnomalies find_anomalies(int jobs, AnomalyCache* cache, RuleAnomalySink* sink, f_interrupt_cb interrupt_cb) const;
+		RuleAnomaly* check_rule(const Rule& rule, const State& state) const;
+		RuleAnomalyDetails* analyze_fully_masked_rule(const Rule& rule, const State& state) const;
+		RuleAnomalyDetails* analyze_partially_masked_rule(const Rule& rule, const State& state) const;
+		RuleAnomalyDetails* classify_partially_masked_rule(const Rule& rule, const State& state) const;
 
 		/* Returns all rules having the specified action and where the given rule predicate
 		   is a subset of the other rule.
 		*/
-		RuleList find_is_subset(const Rule& rule, RuleAction action, const Bddcache& cache) const;
+		RuleList find_is_subset(const Rule& rule, RuleAction action) const;
 
 		/* Returns all rules having the specified action and where the other rule predicate
 		   is a subset of the given rule.
 		*/
-		RuleList find_other_is_subset(const Rule& rule, RuleAction action, const Bddcache& cache) const;
+		RuleList find_other_is_subset(const Rule& rule, RuleAction action) const;
+
+		/* Returns true if a rule having the specified action and where the other
+		   rule predicate is a subset of the given rule exists.
+		*/
+		bool has_other_is_subset(const Rule& rule, RuleAction action) const;
 
 		/* Returns all rules having the specified action and where the other rule predicate
 		   intersects the given rule.
 		*/
-		RuleList find_overlaping(const Rule& rule, RuleAction action, const Bddcache& cache) const;
+		RuleList find_overlaping(const Rule& rule, RuleAction action) const;
+
+		/* Returns a near minimal list of rules having the specified action and
+		   where the union of the rule predicates contains the target.  The target
+		   is a subset of the given rule predicate and must be covered by the
+		   preceding rules.  Nearest rules are selected first and a single rule
+		   containing the target is preferred.
+		*/
+		RuleList find_covering(const Rule& rule, RuleAction action, const bdd& target) const;
+
+		/* Returns the rules explaining why a part of a fully masked rule is
+		   hidden by preceding rules having the specified action.
+		*/
+		RuleList explain(const Rule& rule, RuleAction action, const bdd& target) const;
 	};
 }
@@ -6,6 +6,9 @@
 *
 */
 #include "model/anomaly.h"
+
+#include <stdexcept>
+
 #include "fmt/core.h"
 
 namespace fwm {
@@ -56,6 +59,40 @@ namespace fwm {
 
 
 
+	std::string to_string(RuleAnomalyType anomaly_type)
+	{
+		std::string anomaly_type_str;
+
+		switch (anomaly_type) {
+		case RuleAnomalyType::Shadowing:
+			anomaly_type_str = "Shadowed rule";
+			break;
+
+		case RuleAnomalyType::Redundancy:
+			anomaly_type_str = "Redundant rule";
+			break;
+
+		case RuleAnomalyType::Correlation:
+			anomaly_type_str = "Correlated rule";
+			break;
+
+		case RuleAnomalyType::Generalization:
+			anomaly_type_str = "Generalization";
+			break;
+
+		case RuleAnomalyType::RedundancyOrCorrelation:
+			anomaly_type_str = "Redundant or correlated rule";
+			break;
+
+		default:
+			anomaly_type_str = "not available";
+			break;
+		}
+
+		return anomaly_type_str;
+	}
+
+
 	RuleAnomalyDetails::RuleAnomalyDetails(
 		RuleAnomalyScope anomaly_scope,
 		RuleAnomalyLevel anomaly_level,
@@ -68,6 +105,51 @@ namespace fwm {
 	}
 
 
+	bool RuleAnomalyDetails::is_explained() const
+	{
+		for (const RuleList& rules : related_rules()) {
+			if (rules.size() > 0)
+				return true;
+		}
+
+		return false;
+	}
+
+
+	RuleAnomalyDetails* RuleAnomalyDetails::create(
+		RuleAnomalyScope anomaly_scope,
+		RuleAnomalyType anomaly_type,
+		const std::vector<RuleList>& related_rules
+	)
+	{
+		RuleAnomalyDetails* anomaly_details = nullptr;
+
+		if (anomaly_scope == RuleAnomalyScope::FullyMaskedRule && related_rules.size() == 1) {
+			if (anomaly_type == RuleAnomalyType::Shadowing)
+				anomaly_details = new RuleAnomalyShadowed(related_rules[0]);
+			else if (anomaly_type == RuleAnomalyType::Redundancy)
+				anomaly_details = new RuleAnomalyFullRedundant(related_rules[0]);
+		}
+		else if (anomaly_scope == RuleAnomalyScope::PartiallyMaskedRule && related_rules.size() == 1) {
+			if (anomaly_type == RuleAnomalyType::Redundancy)
+				anomaly_details = new RuleAnomalyPartialRedundant(related_rules[0]);
+			else if (anomaly_type == RuleAnomalyType::Correlation)
+				anomaly_details = new RuleAnomalyCorrelated(related_rules[0]);
+			else if (anomaly_type == RuleAnomalyType::Generalization)
+				anomaly_details = new RuleAnomalyGeneralization(related_rules[0]);
+		}
+		else if (anomaly_scope == RuleAnomalyScope::PartiallyMaskedRule && related_rules.size() == 2) {
+			if (anomaly_type == RuleAnomalyType::RedundancyOrCorrelation)
+				anomaly_details = new RuleAnomalyRedundantOrCorrelated(related_rules[0], related_rules[1]);
+		}
+
+		if (!anomaly_details)
+			throw std::runtime_error("internal error : invalid anomaly details");
+
+		return anomaly_details;
+	}
+
+
 	RuleAnomalyShadowed::RuleAnomalyShadowed(
 		const RuleList& shadowing_rules
 	) :
@@ -89,6 +171,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyShadowed::related_rules() const
+	{
+		return { _shadowing_rules };
+	}
+
+
 	RuleAnomalyFullRedundant::RuleAnomalyFullRedundant(
 		const RuleList& redundant_rules
 	) :
@@ -110,6 +198,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyFullRedundant::related_rules() const
+	{
+		return { _redundant_rules };
+	}
+
+
 	RuleAnomalyPartialRedundant::RuleAnomalyPartialRedundant(
 		const RuleList& redundant_rules
 	) :
@@ -133,6 +227,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyPartialRedundant::related_rules() const
+	{
+		return { _redundant_rules };
+	}
+
+
 	RuleAnomalyCorrelated::RuleAnomalyCorrelated(
 		const RuleList& correlated_rules
 	) :
@@ -154,6 +254,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyCorrelated::related_rules() const
+	{
+		return { _correlated_rules };
+	}
+
+
 	RuleAnomalyRedundantOrCorrelated::RuleAnomalyRedundantOrCorrelated(
 		const RuleList& redundant_rules,
 		const RuleList& correlated_rules
@@ -195,6 +301,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyRedundantOrCorrelated::related_rules() const
+	{
+		return { _redundant_rules, _correlated_rules };
+	}
+
+
 	RuleAnomalyGeneralization::RuleAnomalyGeneralization(
 		const RuleList& matching_rules
 	) :
@@ -213,6 +325,12 @@ namespace fwm {
 	}
 
 
+	std::vector<RuleList> RuleAnomalyGeneralization::related_rules() const
+	{
+		return { _matching_rules };
+	}
+
+
 	RuleAnomaly::RuleAnomaly(const Rule& rule, const RuleAnomalyDetails* anomaly_details) :
 		_rule{ rule },
 		_details{ anomaly_details }
@@ -222,7 +340,35 @@ namespace fwm {
 
 	void RuleAnomaly::output(Cell& cell) const
 	{
-		_details->output(cell, _rule);
+		if (_details->is_explained())
+			_details->output(cell, _rule);
+		else
+			cell.append(to_string(_details->anomaly_type()));
+	}
+
+
+	void RuleAnomaly::output(Row& row, bool show_rule_name) const
+	{
+		int col_num = 0;
+
+		row.cell(col_num++).append(_rule.id());
+		if (show_rule_name)
+			row.cell(col_num++).append(_rule.name());
+		_rule.predicate().src_zones().write_to_cell(row.cell(col_num++), MnodeInfoType::NAME);
+		_rule.predicate().dst_zones().write_to_cell(row.cell(col_num++), MnodeInfoType::NAME);
+
+		row.cell(col_num++).append(to_string(_details->anomaly_scope()));
+		row.cell(col_num++).append(to_string(_details->anomaly_level()));
+		output(row.cell(col_num++));
+	}
+
+
+	RuleAnomaly* RuleAnomaly::clone() const
+	{
+		return new RuleAnomaly(
+			_rule,
+			RuleAnomalyDetails::create(_details->anomaly_scope(), _details->anomaly_type(), _details->related_rules())
+		);
 	}
 
 
@@ -234,7 +380,7 @@ namespace fwm {
 	}
 
 
-	Table RuleAnomalies::output_anomalies(bool show_rule_name) const
+	Table::Headers RuleAnomalies::headers(bool show_rule_name)
 	{
 		Table::Headers columns {
 			"id",
@@ -246,6 +392,15 @@ namespace fwm {
 			"details"
 		};
 
+		if (!show_rule_name)
+			columns.erase(columns.begin() + 1);
+
+		return columns;
+	}
+
+
+	Table RuleAnomalies::output_anomalies(bool show_rule_name) const
+	{
 		Table::WrapPositions wrap_positions{
 			0,
 			0,
@@ -256,27 +411,12 @@ namespace fwm {
 			40
 		};
 
-		if (!show_rule_name) {
-			columns.erase(columns.begin() + 1);
+		if (!show_rule_name)
 			wrap_positions.erase(wrap_positions.begin() + 1);
-		}
 
-		Table anomaly_table{ columns, wrap_positions };
-		for (auto& anomaly : *this) {
-			Row& row = anomaly_table.add_row();
-			int col_num = 0;
-
-			row.cell(col_num++).append(anomaly->rule().id());
-			if (show_rule_name)
-				row.cell(col_num++).append(anomaly->rule().name());
-			anomaly->rule().predicate().src_zones().write_to_cell(row.cell(col_num++), MnodeInfoType::NAME);
-			anomaly->rule().predicate().dst_zones().write_to_cell(row.cell(col_num++), MnodeInfoType::NAME);
-
-			const RuleAnomalyDetails& anomaly_details = anomaly->details();
-			row.cell(col_num++).append(to_string(anomaly_details.anomaly_scope()));
-			row.cell(col_num++).append(to_string(anomaly_details.anomaly_level()));
-			anomaly->output(row.cell(col_num++));
-		}
+		Table anomaly_table{ headers(show_rule_name), wrap_positions };
+		for (auto& anomaly : *this)
+			anomaly->output(anomaly_table.add_row(), show_rule_name);
 
 		return anomaly_table;
 	}
@@ -11,9 +11,11 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "model/rule.h"
 #include "model/rulelist.h"
+#include "model/table.h"
 
 
 namespace fwm {
@@ -40,12 +42,40 @@ namespace fwm {
 		RedundancyOrCorrelation
 	};
 
+	std::string to_string(RuleAnomalyType anomaly_type);
+
+	/* The rules reported in the details of a fully masked rule.
+	*/
+	enum class RuleAnomalyExplanation {
+		AllRules,               // all preceding rules overlapping the rule
+		MinimalRules,           // a near minimal set of preceding rules covering the rule
+		NoRules                 // classification only, no rule is reported
+	};
+
 
 	class RuleAnomalyDetails abstract {
 	public:
 		virtual ~RuleAnomalyDetails() {};
 		virtual void output(Cell& cell, const Rule& rule) const = 0;
 
+		/* Returns the lists of rules involved in this anomaly.
+		*/
+		virtual std::vector<RuleList> related_rules() const = 0;
+
+		/* Returns false if the anomaly was classified without searching for
+		 * the related rules.
+		*/
+		bool is_explained() const;
+
+		/* Allocates the anomaly details identified by the scope and the type
+		 * from the lists of rules involved in the anomaly.  The function throws
+		 * a runtime_error if the combination is not valid.
+		*/
+		static RuleAnomalyDetails* create(
+			RuleAnomalyScope anomaly_scope,
+			RuleAnomalyType anomaly_type,
+			const std::vector<RuleList>& related_rules);
+
 		virtual RuleAnomalyScope anomaly_scope() const noexcept { return _anomaly_scope; }
 		inline RuleAnomalyLevel anomaly_level() const noexcept { return _anomaly_level; }
 		inline RuleAnomalyType anomaly_type() const noexcept { return _anomaly_type; }
@@ -64,6 +94,7 @@ namespace fwm {
 	public:
 		explicit RuleAnomalyShadowed(const RuleList& shadowing_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _shadowing_rules;
@@ -74,6 +105,7 @@ namespace fwm {
 	public:
 		RuleAnomalyFullRedundant(const RuleList& redundant_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _redundant_rules;
@@ -84,6 +116,7 @@ namespace fwm {
 	public:
 		RuleAnomalyPartialRedundant(const RuleList& redundant_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _redundant_rules;
@@ -94,6 +127,7 @@ namespace fwm {
 	public:
 		RuleAnomalyCorrelated(const RuleList& correlated_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _correlated_rules;
@@ -104,6 +138,7 @@ namespace fwm {
 	public:
 		RuleAnomalyRedundantOrCorrelated(const RuleList& redundant_rules, const RuleList& correlated_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _redundant_rules;
@@ -115,6 +150,7 @@ namespace fwm {
 	public:
 		RuleAnomalyGeneralization(const RuleList& matching_rules);
 		virtual void output(Cell& cell, const Rule& rule) const override;
+		virtual std::vector<RuleList> related_rules() const override;
 
 	private:
 		const RuleList _matching_rules;
@@ -127,6 +163,15 @@ namespace fwm {
 		RuleAnomaly(const Rule& rule, const RuleAnomalyDetails* anomaly_details);
 		void output(Cell& cell) const;
 
+		/* Writes this anomaly in a row having the columns returned by
+		 * RuleAnomalies::headers.
+		*/
+		void output(Row& row, bool show_rule_name) const;
+
+		/* Returns a copy of this anomaly.
+		*/
+		RuleAnomaly* clone() const;
+
 		inline const Rule& rule() const noexcept { return _rule; }
 		inline const RuleAnomalyDetails& details() const noexcept { return *_details; }
 
@@ -144,6 +189,10 @@ namespace fwm {
 		RuleAnomalies();
 		Table output_anomalies(bool show_rule_name) const;
 
+		/* Returns the columns of the anomalies table.
+		*/
+		static Table::Headers headers(bool show_rule_name);
+
 		bool missing_deny_all;
 	};
 
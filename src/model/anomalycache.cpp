@@ -0,0 +1,124 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/anomalycache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "model/domains.h"
+
+
+namespace fwm {
+
+	AnomalyCache::AnomalyCache(size_t interval) :
+		_interval{ std::max<size_t>(interval, 1) },
+		_explanation{ RuleAnomalyExplanation::AllRules },
+		_epoch{ 0 },
+		_rules{},
+		_results{},
+		_checkpoints{}
+	{
+	}
+
+
+	size_t AnomalyCache::prefix_size(const std::vector<const Rule*>& acl) const
+	{
+		// The results were computed with the bdds of another epoch.
+		if (_epoch != Domains::get().epoch())
+			return 0;
+
+		const size_t max_size = std::min(acl.size(), _rules.size());
+
+		size_t size = 0;
+		while (size < max_size && acl[size] == _rules[size])
+			size++;
+
+		// The result of the last rule depends on its position since a deny all
+		// rule is not analyzed when it is the last rule of the acl.
+		if (size > 0 && (size == _rules.size() || size == acl.size()))
+			size--;
+
+		return size;
+	}
+
+
+	void AnomalyCache::truncate(size_t size)
+	{
+		if (size < _rules.size()) {
+			_rules.resize(size);
+			_results.resize(size);
+		}
+
+		const size_t checkpoint_count = size / _interval + 1;
+		if (checkpoint_count < _checkpoints.size())
+			_checkpoints.erase(_checkpoints.begin() + checkpoint_count, _checkpoints.end());
+	}
+
+
+	size_t AnomalyCache::checkpoint_position(size_t position) const
+	{
+		if (_checkpoints.empty() || _epoch != Domains::get().epoch())
+			return npos;
+
+		const size_t index = std::min(position / _interval, _checkpoints.size() - 1);
+		return index * _interval;
+	}
+
+
+	const State& AnomalyCache::checkpoint(size_t position) const
+	{
+		if (position % _interval != 0 || position / _interval >= _checkpoints.size())
+			throw std::runtime_error("internal error : invalid checkpoint position");
+
+		return _checkpoints[position / _interval];
+	}
+
+
+	void AnomalyCache::add_checkpoint(const State& state)
+	{
+		const size_t position = _rules.size();
+
+		if (position % _interval == 0 && position / _interval == _checkpoints.size()) {
+			if (_checkpoints.empty())
+				_epoch = Domains::get().epoch();
+			_checkpoints.push_back(state);
+		}
+	}
+
+
+	void AnomalyCache::add_result(const Rule* rule, const RuleAnomaly* anomaly)
+	{
+		_rules.push_back(rule);
+		_results.push_back(RuleAnomalyPtr(anomaly ? anomaly->clone() : nullptr));
+	}
+
+
+	RuleAnomaly* AnomalyCache::result(size_t position) const
+	{
+		const RuleAnomalyPtr& anomaly = _results.at(position);
+		return anomaly ? anomaly->clone() : nullptr;
+	}
+
+
+	void AnomalyCache::set_explanation(RuleAnomalyExplanation explanation)
+	{
+		if (explanation != _explanation) {
+			clear();
+			_explanation = explanation;
+		}
+	}
+
+
+	void AnomalyCache::clear()
+	{
+		_rules.clear();
+		_results.clear();
+		_checkpoints.clear();
+	}
+
+}
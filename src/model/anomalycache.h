@@ -0,0 +1,118 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <vector>
+
+#include "model/anomaly.h"
+#include "model/rule.h"
+#include "model/state.h"
+
+
+namespace fwm {
+
+	/**
+	 * An AnomalyCache keeps the results of the last anomaly analysis of an acl.
+	 *
+	 * The cache records the anomaly found for each rule and a snapshot of the
+	 * analyzer state every 'interval' rules.  When the acl is analyzed again,
+	 * the results of the leading rules that did not change are reused and the
+	 * analysis restarts from the nearest checkpoint.  The results are ignored
+	 * when the epoch of the domains changed since they were recorded.
+	*/
+	class AnomalyCache final
+	{
+	public:
+		explicit AnomalyCache(size_t interval = 100);
+
+		/**
+		 * Returns the explanation mode of the cached results.
+		*/
+		inline RuleAnomalyExplanation explanation() const noexcept { return _explanation; }
+
+		/**
+		 * Removes all results if they were computed with another explanation
+		 * mode.
+		*/
+		void set_explanation(RuleAnomalyExplanation explanation);
+
+		/**
+		 * Returns the number of rules between two checkpoints.
+		*/
+		inline size_t interval() const noexcept { return _interval; }
+
+		/**
+		 * Returns the number of leading rules of the acl for which the cached
+		 * results remain valid.
+		*/
+		size_t prefix_size(const std::vector<const Rule*>& acl) const;
+
+		/**
+		 * Removes the results of the rules following the first 'size' rules.
+		*/
+		void truncate(size_t size);
+
+		/**
+		 * Returns the position of the nearest checkpoint before 'position'.
+		 * The function returns npos if no checkpoint is available.
+		*/
+		size_t checkpoint_position(size_t position) const;
+
+		/**
+		 * Returns the state recorded before analyzing the rule at 'position'.
+		*/
+		const State& checkpoint(size_t position) const;
+
+		/**
+		 * Records the state before analyzing the next rule if this rule is at a
+		 * checkpoint position.
+		*/
+		void add_checkpoint(const State& state);
+
+		/**
+		 * Records the result of the analysis of the next rule.  The anomaly is
+		 * copied, a null pointer means that the rule has no anomaly.
+		*/
+		void add_result(const Rule* rule, const RuleAnomaly* anomaly);
+
+		/**
+		 * Returns a copy of the anomaly found for the rule at 'position' or a
+		 * null pointer if the rule has no anomaly.
+		*/
+		RuleAnomaly* result(size_t position) const;
+
+		/**
+		 * Removes all results.
+		*/
+		void clear();
+
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+	private:
+		// Number of rules between two checkpoints.
+		const size_t _interval;
+
+		// The explanation mode of the cached results.
+		RuleAnomalyExplanation _explanation;
+
+		// Epoch of the domains when the first checkpoint was recorded.
+		unsigned int _epoch;
+
+		// The analyzed rules.
+		std::vector<const Rule*> _rules;
+
+		// The anomaly of each analyzed rule.
+		std::vector<RuleAnomalyPtr> _results;
+
+		// The state before analyzing the rules at position 0, interval,
+		// 2*interval, ...
+		std::vector<State> _checkpoints;
+	};
+
+}
@@ -0,0 +1,119 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/anomalysink.h"
+
+#include "model/table.h"
+#include "tools/strutil.h"
+#include "fmt/core.h"
+
+
+namespace fwm {
+
+	namespace {
+
+		std::string json_quote(const std::string& str)
+		{
+			std::string quoted{ "\"" };
+
+			for (const char c : str) {
+				switch (c) {
+				case '"':
+					quoted += "\\\"";
+					break;
+				case '\\':
+					quoted += "\\\\";
+					break;
+				case '\n':
+					quoted += "\\n";
+					break;
+				case '\t':
+					quoted += "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						quoted += fmt::format("\\u{:04x}", static_cast<int>(c));
+					else
+						quoted += c;
+				}
+			}
+			quoted += '"';
+
+			return quoted;
+		}
+
+	}
+
+
+	RuleAnomalySink::RuleAnomalySink() :
+		missing_deny_all{ false },
+		_count{ 0 }
+	{
+	}
+
+
+	void RuleAnomalySink::add(const RuleAnomaly& anomaly)
+	{
+		write(anomaly);
+		_count++;
+	}
+
+
+	RuleAnomalyCsvSink::RuleAnomalyCsvSink(std::ostream& os, bool show_rule_name) :
+		_os{ os },
+		_show_rule_name{ show_rule_name },
+		_col_count{ RuleAnomalies::headers(show_rule_name).size() }
+	{
+		_os << rat::strings_join(RuleAnomalies::headers(_show_rule_name), ",", true) << std::endl;
+	}
+
+
+	void RuleAnomalyCsvSink::write(const RuleAnomaly& anomaly)
+	{
+		Row row{ _col_count };
+		anomaly.output(row, _show_rule_name);
+
+		std::vector<std::string> values;
+		for (size_t col_num = 0; col_num < _col_count; col_num++)
+			values.push_back(row.cell(col_num).to_string("\n"));
+
+		// The line is flushed to make the anomaly immediately available.
+		_os << rat::strings_join(values, ",", true) << std::endl;
+	}
+
+
+	RuleAnomalyJsonSink::RuleAnomalyJsonSink(std::ostream& os, bool show_rule_name) :
+		_os{ os },
+		_show_rule_name{ show_rule_name },
+		_keys{ RuleAnomalies::headers(show_rule_name) }
+	{
+	}
+
+
+	void RuleAnomalyJsonSink::write(const RuleAnomaly& anomaly)
+	{
+		Row row{ _keys.size() };
+		anomaly.output(row, _show_rule_name);
+
+		std::string line{ "{" };
+		for (size_t col_num = 0; col_num < _keys.size(); col_num++) {
+			if (col_num > 0)
+				line += ", ";
+
+			line += json_quote(_keys[col_num]);
+			line += ": ";
+			if (col_num == 0)
+				line += std::to_string(anomaly.rule().id());
+			else
+				line += json_quote(row.cell(col_num).to_string("\n"));
+		}
+		line += "}";
+
+		_os << line << std::endl;
+	}
+
+}
@@ -0,0 +1,87 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "model/anomaly.h"
+
+
+namespace fwm {
+
+	/**
+	 * A RuleAnomalySink receives the anomalies as soon as they are found by
+	 * the analyzer.  The anomalies are not kept in memory by the analyzer.
+	*/
+	class RuleAnomalySink abstract
+	{
+	public:
+		RuleAnomalySink();
+		virtual ~RuleAnomalySink() {};
+
+		/* Writes an anomaly.  Anomalies are written in the acl order.
+		*/
+		void add(const RuleAnomaly& anomaly);
+
+		/* Returns the number of anomalies written.
+		*/
+		inline size_t count() const noexcept { return _count; }
+
+		// Set at the end of the analysis when the rules do not end
+		// with a deny all rule.
+		bool missing_deny_all;
+
+	protected:
+		virtual void write(const RuleAnomaly& anomaly) = 0;
+
+	private:
+		size_t _count;
+	};
+
+
+	/**
+	 * Writes the anomalies to a stream in csv format.  The columns are the
+	 * columns of the table returned by RuleAnomalies::output_anomalies.
+	*/
+	class RuleAnomalyCsvSink : public RuleAnomalySink
+	{
+	public:
+		RuleAnomalyCsvSink(std::ostream& os, bool show_rule_name);
+
+	protected:
+		virtual void write(const RuleAnomaly& anomaly) override;
+
+	private:
+		std::ostream& _os;
+		const bool _show_rule_name;
+		const size_t _col_count;
+	};
+
+
+	/**
+	 * Writes the anomalies to a stream in json lines format, one json object
+	 * per anomaly.
+	*/
+	class RuleAnomalyJsonSink : public RuleAnomalySink
+	{
+	public:
+		RuleAnomalyJsonSink(std::ostream& os, bool show_rule_name);
+
+	protected:
+		virtual void write(const RuleAnomaly& anomaly) override;
+
+	private:
+		std::ostream& _os;
+		const bool _show_rule_name;
+		const std::vector<std::string> _keys;
+	};
+
+}
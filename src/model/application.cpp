@@ -89,19 +89,21 @@ namespace fwm {
 
 	bdd Application::make_bdd() const
 	{
-		bdd result{ bddtrue };
+		return _bdd_cache.get([this]() -> bdd {
+			bdd result{ bddtrue };
 
-		if (options().contains(ModelOption::Application)) {
-			// Application mode is enabled in the model.
-			result &= _app_value->make_bdd();
-		}
+			if (options().contains(ModelOption::Application)) {
+				// Application mode is enabled in the model.
+				result &= _app_value->make_bdd();
+			}
 
-		if (_use_app_svc) {
-			// Default services enabled on this application.
-			result &= _services->make_bdd();
-		}
+			if (_use_app_svc) {
+				// Default services enabled on this application.
+				result &= _services->make_bdd();
+			}
 
-		return result;
+			return result;
+		});
 	}
 
 
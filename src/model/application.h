@@ -82,6 +82,9 @@ namespace fwm {
 		const MvaluePtr _app_value;
 		const bool _use_app_svc;
 		const ServiceGroupPtr _services;
+
+		// The bdd of this application, it depends on the model options.
+		BddCache _bdd_cache;
 	};
 
 
@@ -9,10 +9,15 @@
 
 namespace fwm {
 
-	PolicylistRelationShip PolicyListComparator::compare(const RuleList& rule_list1, const RuleList& rule_list2)
+	PolicylistRelationShip PolicyListComparator::compare(
+		const RuleList& rule_list1,
+		const RuleList& rule_list2,
+		Profiler* profiler)
 	{
-		const auto bdd_list1{ compute_bdd(rule_list1) };
-		const auto bdd_list2{ compute_bdd(rule_list2) };
+		const auto bdd_list1{ compute_bdd(rule_list1, profiler) };
+		const auto bdd_list2{ compute_bdd(rule_list2, profiler) };
+
+		Profiler::Scope scope(profiler, Profiler::Phase::PolicyCompare);
 
 		// Compare allowed (tuple 0) and denied (tuple 1) rules.
 		PolicylistRelationShip relations{
@@ -24,18 +29,25 @@ namespace fwm {
 	}
 
 
-	std::tuple<Bddnode, Bddnode> PolicyListComparator::compute_bdd(const RuleList& rule_list)
+	std::tuple<Bddnode, Bddnode> PolicyListComparator::compute_bdd(const RuleList& rule_list, Profiler* profiler)
 	{
 		bdd allowed;
 		bdd denied;
 
 		for (const Rule* rule : rule_list) {
 			if (rule->status() == RuleStatus::ENABLED) {
+				bdd rule_bdd;
+				{
+					Profiler::Scope scope(profiler, Profiler::Phase::MakeBdd);
+					rule_bdd = rule->predicate_bdd().make_bdd();
+				}
+
+				Profiler::Scope scope(profiler, Profiler::Phase::PolicyCompare);
 				if (rule->action() == RuleAction::ALLOW) {
-					allowed = allowed | (rule->predicate().make_bdd() - denied);
+					allowed = allowed | (rule_bdd - denied);
 				}
 				else {
-					denied = denied | (rule->predicate().make_bdd() - allowed);
+					denied = denied | (rule_bdd - allowed);
 				}
 			}
 		}
@@ -11,6 +11,7 @@
 #include <tuple>
 
 #include "model/mnode.h"
+#include "model/profiler.h"
 #include "model/rulelist.h"
 
 namespace fwm {
@@ -23,10 +24,18 @@ namespace fwm {
 
 	class PolicyListComparator {
 	public:
-		static PolicylistRelationShip compare(const RuleList& rule_list1, const RuleList& rule_list2);
+		/* Compares the packets allowed and denied by two rule lists.  The
+		 * phases of the comparison are measured by the profiler when it is
+		 * not null.
+		*/
+		static PolicylistRelationShip compare(
+			const RuleList& rule_list1,
+			const RuleList& rule_list2,
+			Profiler* profiler = nullptr
+		);
 
 	private:
-		static std::tuple<Bddnode, Bddnode> compute_bdd(const RuleList& rule_list);
+		static std::tuple<Bddnode, Bddnode> compute_bdd(const RuleList& rule_list, Profiler* profiler);
 	};
 
 }
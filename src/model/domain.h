@@ -90,7 +90,7 @@ namespace fwm {
 		static Range* create_full_range();
 		static Range* create_singleton(uint16_t value);
 
-		static constexpr int nbits() { return 8; }
+		static constexpr int nbits() { return 16; }
 		static constexpr uint16_t min() { return 0; }
 		static constexpr uint16_t max() { return (1 << nbits()) - 1; }
 
@@ -242,7 +242,7 @@ namespace fwm {
 		static Range* create_full_range();
 		static Range* create_singleton(uint16_t value);
 
-		static constexpr int nbits() { return 10; }
+		static constexpr int nbits() { return 16; }
 		static constexpr uint16_t min() { return 0; }
 		static constexpr uint16_t max() { return (1 << nbits()) - 1; }
 	};
@@ -257,7 +257,7 @@ namespace fwm {
 		static Range* create_full_range();
 		static Range* create_singleton(uint16_t value);
 
-		static constexpr int nbits() { return 11; }
+		static constexpr int nbits() { return 16; }
 		static constexpr uint16_t min() { return 0; }
 		static constexpr uint16_t max() { return (1 << nbits()) - 1; }
 	};
@@ -272,7 +272,7 @@ namespace fwm {
 		static Range* create_full_range();
 		static Range* create_singleton(uint16_t value);
 
-		static constexpr int nbits() { return 11; }
+		static constexpr int nbits() { return 16; }
 		static constexpr uint16_t min() { return 0; }
 		static constexpr uint16_t max() { return (1 << nbits()) - 1; }
 	};
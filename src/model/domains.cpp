@@ -7,15 +7,298 @@
 */
 #include "model/domains.h"
 
+#include <algorithm>
+#include <atomic>
+#include <ctime>
 #include <stdexcept>
+#include <utility>
 
 #include "model/domain.h"
+#include "fmt/core.h"
 
 
 namespace fwm {
 
-	Domains::Domains()
+	namespace {
+
+		const char* DOMAIN_NAMES[] = {
+			"src.zone",
+			"src.addr4",
+			"src.addr6",
+			"dst.zone",
+			"dst.addr4",
+			"dst.addr6",
+			"protocol",
+			"tcp.port",
+			"udp.port",
+			"icmp.type",
+			"app",
+			"user",
+			"url"
+		};
+
+
+		/* Returns the groups of domains in the order of their variables.  The
+		 * bits of the domains of a group are interleaved.
+		*/
+		std::vector<std::vector<DomainType>> variable_groups(VariableOrder order)
+		{
+			switch (order) {
+			case VariableOrder::Interleaved:
+				return {
+					{ DomainType::SrcZone, DomainType::DstZone },
+					{ DomainType::SrcAddress4, DomainType::DstAddress4 },
+					{ DomainType::SrcAddress6, DomainType::DstAddress6 },
+					{ DomainType::Protocol },
+					{ DomainType::DstTcpPort },
+					{ DomainType::DstUdpPort },
+					{ DomainType::IcmpType },
+					{ DomainType::Application },
+					{ DomainType::User },
+					{ DomainType::Url }
+				};
+
+			case VariableOrder::ZonesFirst:
+				return {
+					{ DomainType::SrcZone },
+					{ DomainType::DstZone },
+					{ DomainType::Protocol },
+					{ DomainType::DstTcpPort },
+					{ DomainType::DstUdpPort },
+					{ DomainType::IcmpType },
+					{ DomainType::Application },
+					{ DomainType::User },
+					{ DomainType::Url },
+					{ DomainType::SrcAddress4 },
+					{ DomainType::DstAddress4 },
+					{ DomainType::SrcAddress6 },
+					{ DomainType::DstAddress6 }
+				};
+
+			default:
+				return {
+					{ DomainType::SrcZone },
+					{ DomainType::SrcAddress4 },
+					{ DomainType::SrcAddress6 },
+					{ DomainType::DstZone },
+					{ DomainType::DstAddress4 },
+					{ DomainType::DstAddress6 },
+					{ DomainType::Protocol },
+					{ DomainType::DstTcpPort },
+					{ DomainType::DstUdpPort },
+					{ DomainType::IcmpType },
+					{ DomainType::Application },
+					{ DomainType::User },
+					{ DomainType::Url }
+				};
+			}
+		}
+
+
+		/* Returns the domains allocated together with the given domain.  The
+		 * source and destination zones and addresses are exchanged by swap_src_dst
+		 * and must have the same number of bits.
+		*/
+		std::vector<DomainType> linked_domains(DomainType dt)
+		{
+			switch (dt) {
+			case DomainType::SrcZone:
+			case DomainType::DstZone:
+				return { DomainType::SrcZone, DomainType::DstZone };
+
+			case DomainType::SrcAddress4:
+			case DomainType::DstAddress4:
+				return { DomainType::SrcAddress4, DomainType::DstAddress4 };
+
+			case DomainType::SrcAddress6:
+			case DomainType::DstAddress6:
+				return { DomainType::SrcAddress6, DomainType::DstAddress6 };
+
+			default:
+				return { dt };
+			}
+		}
+
+
+		/* Returns true if the number of bits of a domain depends on the ids
+		 * reserved in the domain.
+		*/
+		bool is_sized(DomainType dt)
+		{
+			switch (dt) {
+			case DomainType::SrcZone:
+			case DomainType::DstZone:
+			case DomainType::Application:
+			case DomainType::User:
+			case DomainType::Url:
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+
+		/* Returns true if a domain is used by all models.
+		*/
+		bool is_always_used(DomainType dt)
+		{
+			switch (dt) {
+			case DomainType::Protocol:
+			case DomainType::DstTcpPort:
+			case DomainType::DstUdpPort:
+			case DomainType::IcmpType:
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+
+		/* Returns the number of bits needed to represent an id, at least 1.
+		*/
+		int id_nbits(uint32_t id)
+		{
+			int nbits = 1;
+			while (nbits < 32 && (id >> nbits) != 0)
+				nbits++;
+
+			return nbits;
+		}
+
+
+		/* Throws an exception if a bdd library function failed.
+		*/
+		void check_bdd_error(int err)
+		{
+			if (err < 0)
+				throw std::runtime_error("bdd initialization error : " + std::string(bdd_errstring(err)));
+		}
+
+
+		/* Adds to the pair the exchange of the bits of two variables starting
+		 * from the given bit.
+		*/
+		void add_swapped_bits(bddPair* pair, const bvec& var1, const bvec& var2, int first_bit)
+		{
+			if (var1.bitnum() != var2.bitnum())
+				throw std::runtime_error("internal error : source and destination domains mismatch");
+
+			for (int bit = first_bit; bit < var1.bitnum(); bit++) {
+				check_bdd_error(bdd_setpair(pair, bdd_var(var1[bit]), bdd_var(var2[bit])));
+				check_bdd_error(bdd_setpair(pair, bdd_var(var2[bit]), bdd_var(var1[bit])));
+			}
+		}
+
+
+		// The domains exchanged by swap_src_dst.
+		const std::pair<DomainType, DomainType> SWAPPED_DOMAINS[] = {
+			{ DomainType::SrcZone, DomainType::DstZone },
+			{ DomainType::SrcAddress4, DomainType::DstAddress4 },
+			{ DomainType::SrcAddress6, DomainType::DstAddress6 }
+		};
+
+
+		int buddy_method(ReorderMethod method)
+		{
+			switch (method) {
+			case ReorderMethod::Sift:
+				return BDD_REORDER_SIFT;
+
+			case ReorderMethod::Win2:
+				return BDD_REORDER_WIN2ITE;
+
+			case ReorderMethod::Win3:
+				return BDD_REORDER_WIN3ITE;
+
+			default:
+				return BDD_REORDER_NONE;
+			}
+		}
+
+
+		// Reordering statistics of the bdd manager of the current thread.
+		thread_local int reorder_counter = 0;
+		thread_local clock_t reorder_clock = 0;
+		thread_local clock_t reorder_start = 0;
+
+
+		// Last epoch given to a domains collection.  The epochs are unique in
+		// the process, a bdd memoized by another thread is never reused.
+		std::atomic<unsigned int> last_epoch{ 0 };
+
+		void reorder_handler(int prestate)
+		{
+			if (prestate) {
+				reorder_start = clock();
+			}
+			else {
+				reorder_counter++;
+				reorder_clock += clock() - reorder_start;
+			}
+		}
+
+
+		/* Lets an operation fail when the node table reached its maximum
+		 * size, the bdd C++ interface then raises a bddnodeerror and the
+		 * analysis is aborted.  The other errors remain fatal.
+		*/
+		void error_handler(int err)
+		{
+			if (err != BDD_NODENUM)
+				bdd_default_errhandler(err);
+		}
+
+	}
+
+
+	std::string to_string(VariableOrder order)
 	{
+		switch (order) {
+		case VariableOrder::Interleaved:
+			return "interleaved";
+
+		case VariableOrder::ZonesFirst:
+			return "zones-first";
+
+		default:
+			return "domain";
+		}
+	}
+
+
+	std::string to_string(ReorderMethod method)
+	{
+		switch (method) {
+		case ReorderMethod::Sift:
+			return "sift";
+
+		case ReorderMethod::Win2:
+			return "win2";
+
+		case ReorderMethod::Win3:
+			return "win3";
+
+		default:
+			return "none";
+		}
+	}
+
+
+	Domains::Domains() :
+		_initialized{ false },
+		_nbits{},
+		_used{},
+		_vars{},
+		_domains{},
+		_order{ VariableOrder::Domain },
+		_method{ ReorderMethod::None },
+		_epoch{ 0 },
+		_src_dst_pair{ nullptr }
+	{
+		next_epoch();
+
 		// Warning : initialization order must match the DomainType order.
 		_domains.push_back(new SrcZoneDomain());
 		_domains.push_back(new SrcAddress4Domain());
@@ -30,6 +313,13 @@ namespace fwm {
 		_domains.push_back(new ApplicationDomain());
 		_domains.push_back(new UserDomain());
 		_domains.push_back(new UrlDomain());
+
+		// The zone, application, user and url variables grow with the ids
+		// reserved by the networks.
+		for (const Domain* domain : _domains) {
+			_nbits.push_back(is_sized(domain->dt()) ? 1 : domain->range().nbits());
+			_used.push_back(is_always_used(domain->dt()));
+		}
 	}
 
 
@@ -43,48 +333,259 @@ namespace fwm {
 
 	Domains& Domains::get()
 	{
-		static Domains domains;
+		static thread_local Domains domains;
 		return domains;
 	}
 
 
-	void Domains::init_bdd(int node_size, int cache_size)
+	void Domains::init_bdd(int node_size, int cache_size, VariableOrder order, ReorderMethod method)
 	{
-		int err = 0;
-
-		if (_vars.size() == 0) {
+		if (!_initialized) {
 			// Initialize the bdd library.
-			bdd_autoreorder(BDD_REORDER_NONE);
-			err = bdd_init(node_size, cache_size);
-			if (err < 0) goto error;
+			check_bdd_error(bdd_init(node_size, cache_size));
+			_initialized = true;
+
+			// An operation running out of nodes raises an exception.  The node
+			// table starts small and grows on demand, the garbage collections
+			// are silent unless an analysis installs a GbcHandler.
+			bdd_error_hook(error_handler);
+			bdd_gbc_hook(nullptr);
+
+			// Enable the dynamic reordering.
+			reorder_counter = 0;
+			reorder_clock = 0;
+			bdd_reorder_hook(reorder_handler);
+			bdd_autoreorder(buddy_method(method));
+			_order = order;
+			_method = method;
+			next_epoch();
+		}
+	}
+
+
+	void Domains::set_growth_policy(int max_increase, int min_free_nodes, int max_memory)
+	{
+		if (!_initialized)
+			throw std::runtime_error("internal error : domains not initialized");
+
+		// The error handler is disabled to report an invalid setting as an
+		// exception instead of exiting.
+		const bddinthandler handler = bdd_error_hook(nullptr);
+		int err = bdd_setmaxincrease(max_increase);
+		if (err >= 0)
+			err = bdd_setminfreenodes(min_free_nodes);
+		if (err >= 0)
+			err = bdd_setmaxmemory(max_memory);
+		bdd_error_hook(handler);
+
+		check_bdd_error(err);
+	}
+
+
+	void Domains::set_cache_budget(int min_cache_size, int max_cache_size)
+	{
+		if (!_initialized)
+			throw std::runtime_error("internal error : domains not initialized");
+
+		const bddinthandler handler = bdd_error_hook(nullptr);
+		const int err = bdd_setcachebudget(min_cache_size, max_cache_size);
+		bdd_error_hook(handler);
+
+		check_bdd_error(err);
+	}
+
 
-			// Allocate all variables.
-			int nvars = 0;
-			for (int dn = 0; dn < _domains.size(); dn++) {
-				nvars += _domains[dn]->range().nbits();
+	void Domains::allocate_vars()
+	{
+		if (!_initialized)
+			throw std::runtime_error("internal error : domains not initialized");
+
+		// Allocate the variables of the used domains.
+		int nvars = 0;
+		for (size_t dn = 0; dn < _domains.size(); dn++) {
+			if (_used[dn])
+				nvars += _nbits[dn];
+		}
+		check_bdd_error(::bdd_setvarnum(nvars));
+
+		// Create a vector of variables for each domain.  The variables of
+		// a group are registered as a block, the blocks are moved as a whole
+		// when the variables are reordered.
+		_vars.resize(_domains.size());
+		int offset = 0;
+		for (const std::vector<DomainType>& group : variable_groups(_order)) {
+			if (!_used[static_cast<int>(group.front())])
+				continue;
+
+			const int nbits = _nbits[static_cast<int>(group.front())];
+			const int step = static_cast<int>(group.size());
+
+			for (int index = 0; index < step; index++) {
+				const int dn = static_cast<int>(group[index]);
+				if (_nbits[dn] != nbits)
+					throw std::runtime_error("internal error : interleaved domains mismatch");
+
+				_vars[dn] = bvec_var(nbits, offset + index, step);
 			}
-			err = ::bdd_setvarnum(nvars);
-			if (err < 0) goto error;
 
-			// Create a vector of variables for each domain.
-			for (int dn = 0, offset = 0; dn < _domains.size(); dn++) {
-				const int nbits = _domains[dn]->range().nbits();
-				_vars.push_back(bvec_var(nbits, offset, 1));
-				offset += nbits;
+			offset += nbits * step;
+		}
+		add_var_blocks();
+
+		// Create the pairs of variables exchanged by swap_src_dst.
+		_src_dst_pair = bdd_newpair();
+		if (!_src_dst_pair)
+			check_bdd_error(BDD_MEMORY);
+
+		for (const auto& domains : SWAPPED_DOMAINS) {
+			const bvec& src_var = _vars[static_cast<int>(domains.first)];
+			const bvec& dst_var = _vars[static_cast<int>(domains.second)];
+			add_swapped_bits(_src_dst_pair, src_var, dst_var, 0);
+		}
+	}
+
+
+	void Domains::add_var_blocks()
+	{
+		// The variables of a group have consecutive indexes, the bits of the
+		// interleaved domains alternate.
+		for (const std::vector<DomainType>& group : variable_groups(_order)) {
+			const bvec& var = _vars[static_cast<int>(group.front())];
+			if (var.bitnum() == 0)
+				continue;
+
+			const int first = bdd_var(var[0]);
+			const int last = first + var.bitnum() * static_cast<int>(group.size()) - 1;
+			check_bdd_error(bdd_intaddvarblock(first, last, BDD_REORDER_FIXED));
+		}
+	}
+
+
+	void Domains::extend_vars(const std::vector<DomainType>& domains, int nbits)
+	{
+		const int old_nbits = _vars[static_cast<int>(domains.front())].bitnum();
+
+		// The variables are inserted without blocks, the blocks are registered
+		// again with the new indexes.
+		bdd_clrvarblocks();
+
+		// Index following the variables of the groups already visited.
+		int next_var = 0;
+
+		for (const std::vector<DomainType>& group : variable_groups(_order)) {
+			const int step = static_cast<int>(group.size());
+			const bvec& front_var = _vars[static_cast<int>(group.front())];
+
+			if (std::find(domains.begin(), domains.end(), group.front()) == domains.end()) {
+				if (front_var.bitnum() > 0)
+					next_var = bdd_var(front_var[0]) + front_var.bitnum() * step;
+				continue;
+			}
+
+			// The new bits are inserted after the last bit of the group, or after
+			// the previous group if the domains had no variable.  They take the
+			// levels following these bits and the order of the groups is kept.
+			const int first = old_nbits > 0 ? bdd_var(front_var[0]) : next_var;
+			check_bdd_error(bdd_intinsvarnum(first + old_nbits * step, (nbits - old_nbits) * step));
+
+			for (int index = 0; index < step; index++) {
+				const int dn = static_cast<int>(group[index]);
+				const bvec& old_var = _vars[dn];
+
+				bvec var{ nbits };
+				for (int bit = 0; bit < old_nbits; bit++)
+					var.set(bit, old_var[bit]);
+				for (int bit = old_nbits; bit < nbits; bit++)
+					var.set(bit, bdd_ithvar(first + bit * step + index));
+
+				_vars[dn] = var;
+			}
+
+			next_var = first + nbits * step;
+		}
+
+		add_var_blocks();
+
+		for (const auto& swapped : SWAPPED_DOMAINS) {
+			if (swapped.first == domains.front()) {
+				const bvec& src_var = _vars[static_cast<int>(swapped.first)];
+				const bvec& dst_var = _vars[static_cast<int>(swapped.second)];
+				add_swapped_bits(_src_dst_pair, src_var, dst_var, old_nbits);
 			}
 		}
+	}
+
+
+	void Domains::use(DomainType dt)
+	{
+		const int dn = static_cast<int>(dt);
+		check_dn(dn);
+
+		const std::vector<DomainType> domains{ linked_domains(dt) };
+		for (DomainType domain : domains)
+			_used[static_cast<int>(domain)] = true;
+
+		// Add the variables of this domain if the variables of the other
+		// domains are already allocated.
+		if (!_vars.empty() && _vars[dn].bitnum() == 0)
+			extend_vars(domains, _nbits[dn]);
+	}
+
+
+	bool Domains::reserve(DomainType dt, uint32_t id)
+	{
+		const int dn = static_cast<int>(dt);
+		check_dn(dn);
+
+		if (!is_sized(dt))
+			throw std::runtime_error("internal error : domain size is fixed");
+
+		const std::vector<DomainType> domains{ linked_domains(dt) };
+		const int nbits = id_nbits(id);
+		bool extended = false;
+
+		if (nbits > _nbits[dn]) {
+			if (nbits > _domains[dn]->range().nbits())
+				throw std::runtime_error(fmt::format("{} domain overflow", DOMAIN_NAMES[dn]));
 
-		return;
+			if (!_vars.empty() && _vars[dn].bitnum() > 0) {
+				extend_vars(domains, nbits);
 
-	error:
-		throw std::runtime_error("bdd initialization error : " + std::string(bdd_errstring(err)));
+				// The memoized bdds were built with the previous variables.
+				next_epoch();
+				extended = true;
+			}
+
+			for (DomainType domain : domains)
+				_nbits[static_cast<int>(domain)] = nbits;
+		}
+
+		use(dt);
+		return extended;
 	}
 
 
 	void Domains::reset_bdd()
 	{
 		_vars.clear();
-		bdd_done();
+		if (_src_dst_pair) {
+			bdd_freepair(_src_dst_pair);
+			_src_dst_pair = nullptr;
+		}
+		if (_initialized) {
+			bdd_done();
+			_initialized = false;
+		}
+		next_epoch();
+	}
+
+
+	void Domains::next_epoch()
+	{
+		// Skip 0, the epoch of an empty cache.
+		do {
+			_epoch = ++last_epoch;
+		} while (_epoch == 0);
 	}
 
 
@@ -107,15 +608,86 @@ namespace fwm {
 	}
 
 
-	const bvec& Domains::get_var(DomainType dt) const
+	const bvec& Domains::get_var(DomainType dt)
 	{
 		const int dn = static_cast<int>(dt);
 
 		check_dn(dn);
-		if (_vars.size() != _domains.size())
-			throw std::runtime_error("internal error : domains not initialized");
+		if (_vars.empty())
+			allocate_vars();
+
+		// Allocate on demand the variable of a domain not declared as used.
+		if (_vars[dn].bitnum() == 0)
+			use(dt);
 
 		return _vars[dn];
 	}
 
+
+	int Domains::nbits(DomainType dt) const
+	{
+		const int dn = static_cast<int>(dt);
+
+		check_dn(dn);
+		return _nbits[dn];
+	}
+
+
+	bdd Domains::swap_src_dst(const bdd& b)
+	{
+		if (_vars.empty())
+			allocate_vars();
+
+		return bdd_replace(b, _src_dst_pair);
+	}
+
+
+	int Domains::reorder_count() const
+	{
+		return reorder_counter;
+	}
+
+
+	double Domains::reorder_time() const
+	{
+		return reorder_clock * 1000.0 / CLOCKS_PER_SEC;
+	}
+
+
+	Table Domains::variables_table() const
+	{
+		Table table{ { "domain", "bits", "levels" } };
+
+		for (size_t dn = 0; dn < _domains.size(); dn++) {
+			Row& row = table.add_row();
+			row.cell(0).append(DOMAIN_NAMES[dn]);
+			if (!_used[dn]) {
+				// This domain is not used by the model.
+				row.cell(1).append("-");
+				row.cell(2).append("-");
+				continue;
+			}
+
+			row.cell(1).append(_nbits[dn]);
+
+			if (_vars.empty() || _vars[dn].bitnum() == 0) {
+				// The variables are not yet allocated.
+				row.cell(2).append("-");
+				continue;
+			}
+
+			const bvec& var = _vars[dn];
+			int first_level = bdd_varnum();
+			int last_level = -1;
+			for (int bit = 0; bit < var.bitnum(); bit++) {
+				const int level = bdd_var2level(bdd_var(var[bit]));
+				first_level = std::min(first_level, level);
+				last_level = std::max(last_level, level);
+			}
+			row.cell(2).append(fmt::format("{}-{}", first_level, last_level));
+		}
+
+		return table;
+	}
+
 }
@@ -8,27 +8,78 @@
 #pragma once
 #include "global.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 #include <buddy/bvec.h>
 
 #include "model/domain.h"
+#include "model/table.h"
 
 
 namespace fwm {
 
+	/* The initial order of the bdd variables.
+	*/
+	enum class VariableOrder {
+		Domain,                 // the variables of each domain in the DomainType order
+		Interleaved,            // the source and destination zone and address bits interleaved
+		ZonesFirst              // the zones, protocol, ports and applications before the addresses
+	};
+
+	std::string to_string(VariableOrder order);
+
+
+	/* The dynamic reordering method of the bdd variables.  The variables of
+	 * a domain always stay contiguous and in the same order.
+	*/
+	enum class ReorderMethod {
+		None,
+		Sift,
+		Win2,
+		Win3
+	};
+
+	std::string to_string(ReorderMethod method);
+
+
 	/* A collection of domains.
 	*/
 	class Domains final
 	{
 	public:
-		/* Returns the domains collection.
+		/* Returns the domains collection of the current thread.  Each thread
+		 * has its own bdd manager and must initialize it with init_bdd before
+		 * building bdds.  The bdds and the model nodes memoizing them must only
+		 * be used by the thread that built them.
 		*/
 		static Domains& get();
 
-		/* Initialize the bdd library.
+		/* Initialize the bdd library.  The variables are allocated when the
+		 * first bdd is built.
+		*/
+		void init_bdd(
+			int node_size,
+			int cache_size,
+			VariableOrder order = VariableOrder::Domain,
+			ReorderMethod method = ReorderMethod::None
+		);
+
+		/* Sets how the node table grows once the initial nodes are used.  The
+		 * table doubles its size but gets at most max_increase new nodes at a
+		 * time.  It grows when less than min_free_nodes percent of the nodes
+		 * are free after a garbage collection.  The table never exceeds
+		 * max_memory megabytes, 0 means no limit, an operation needing more
+		 * nodes raises a bddnodeerror.
 		*/
-		void init_bdd(int node_size, int cache_size);
+		void set_growth_policy(int max_increase, int min_free_nodes, int max_memory);
+
+		/* Lets the operator caches adapt their size to the measured hit rate.
+		 * The caches get between min_cache_size and max_cache_size entries,
+		 * a max_cache_size of 0 keeps the size given to init_bdd.
+		*/
+		void set_cache_budget(int min_cache_size, int max_cache_size);
 
 		/* Reclaim memory used by the bdd library.
 		*/
@@ -40,7 +91,73 @@ namespace fwm {
 
 		/* Returns the model variable of the given type.
 		*/
-		const bvec& get_var(DomainType dt) const;
+		const bvec& get_var(DomainType dt);
+
+		/* Returns the number of bits of the model variable of the given type.
+		*/
+		int nbits(DomainType dt) const;
+
+		/* Declares that the model uses the variable of a domain.  The variables
+		 * are only allocated for the domains used by the model, the variables of
+		 * a domain declared after the allocation are inserted at the place of
+		 * the domain in the variable order.  The source and destination zones or
+		 * addresses are always declared together.
+		*/
+		void use(DomainType dt);
+
+		/* Ensures that the variable of a zone, application, user or url domain
+		 * can represent the given id and declares the domain as used.  The source
+		 * and destination zones always have the same number of bits.
+		 *
+		 * The nbits() of these domains is the maximum size of the values, the
+		 * variable only has the bits needed by the largest id reserved so far.
+		 * The bits are allocated with the first bdd and are extended when a
+		 * larger id is reserved later.
+		 *
+		 * Returns true if already allocated variables have been extended.  The
+		 * epoch is then changed : the memoized bdds, the rule bdd stores and the
+		 * anomaly caches of all networks are invalidated, the other bdds built
+		 * before this call must be rebuilt by the caller.
+		*/
+		bool reserve(DomainType dt, uint32_t id);
+
+		/* Returns a copy of the bdd where the variables of the source zone and
+		 * addresses domains are exchanged with the variables of the destination
+		 * zone and addresses domains.
+		*/
+		bdd swap_src_dst(const bdd& b);
+
+		/* Returns the epoch of the bdds memoized in the model nodes.  The
+		 * epoch changes when the bdd library is initialized or reset.
+		*/
+		inline unsigned int epoch() const noexcept { return _epoch; }
+
+		/* Invalidates the bdds memoized in the model nodes.  This function
+		 * must be called when the bdd of a node changes, for example after
+		 * a change of the model options.
+		*/
+		void next_epoch();
+
+		/* Returns the initial order of the variables.
+		*/
+		inline VariableOrder variable_order() const noexcept { return _order; }
+
+		/* Returns the dynamic reordering method.
+		*/
+		inline ReorderMethod reorder_method() const noexcept { return _method; }
+
+		/* Returns the number of reorderings done since the initialization.
+		*/
+		int reorder_count() const;
+
+		/* Returns the time spent in the reorderings in milliseconds.
+		*/
+		double reorder_time() const;
+
+		/* Returns a table showing the number of bits and the current levels
+		 * of the variables of each domain.
+		*/
+		Table variables_table() const;
 
 	private:
 		Domains();
@@ -48,8 +165,41 @@ namespace fwm {
 
 		void check_dn(int dn) const;
 
+		/* Allocates the model variables.
+		*/
+		void allocate_vars();
+
+		/* Registers a fixed block for the variables of each group of domains.
+		*/
+		void add_var_blocks();
+
+		/* Adds bits to the variables of the given domains.  The domains must
+		 * have the same number of bits.  The new bits are inserted in the block
+		 * of their group after the existing bits, the order of the groups given
+		 * by the variable order is kept.
+		*/
+		void extend_vars(const std::vector<DomainType>& domains, int nbits);
+
+		// True when the bdd library is initialized.
+		bool _initialized;
+
+		// Number of bits of the variable of each domain.
+		std::vector<int> _nbits;
+
+		// True if the variable of a domain is used by the model.
+		std::vector<bool> _used;
+
 		std::vector<bvec> _vars;
 		std::vector<Domain *> _domains;
+
+		VariableOrder _order;
+		ReorderMethod _method;
+
+		// Epoch of the memoized bdds, 0 is never used.
+		unsigned int _epoch;
+
+		// Variable pairs used to swap the source and the destination domains.
+		bddPair* _src_dst_pair;
 	};
 
 }
@@ -18,7 +18,9 @@ namespace fwm {
 		_network{ network },
 		_rules{},
 		_rule_list{},
-		_rule_ids{}
+		_rule_ids{},
+		_bdd_store{},
+		_anomaly_cache{}
 	{
 	}
 
@@ -27,7 +29,7 @@ namespace fwm {
 		Firewall(name, other._network)
 	{
 		for (const auto& rule : other._rules)
-			add_rule(new Rule(*rule));
+			add_rule(new Rule(*this, *rule));
 	}
 
 
@@ -36,6 +38,8 @@ namespace fwm {
 		_rule_list.clear();
 		_rules.clear();
 		_rule_ids.clear();
+		_bdd_store.clear();
+		_anomaly_cache.clear();
 	}
 
 
@@ -50,8 +54,10 @@ namespace fwm {
 		_rules.push_back(std::unique_ptr<Rule>(rule));
 
 		Rule* tmp{ _rules.back().get() };
+		tmp->_index = _rules.size() - 1;
 		_rule_list.push_back(tmp);
 		_rule_ids[tmp->id()] = tmp;
+		_bdd_store.resize(_rules.size());
 	}
 
 
@@ -123,6 +129,34 @@ namespace fwm {
 	}
 
 
+	const Bddnode& Firewall::get_rule_bdd(const Rule& rule) const
+	{
+		return _bdd_store.get(rule);
+	}
+
+
+	const Bddnode& Firewall::get_rule_bdd(const Rule& rule, const Predicate::BddOptions& options) const
+	{
+		return _bdd_store.get(rule, options);
+	}
+
+
+	void Firewall::invalidate_rule_bdd(const Rule& rule)
+	{
+		_bdd_store.invalidate(rule);
+	}
+
+
+	void Firewall::clear_rule_bdds()
+	{
+		_bdd_store.clear();
+		_bdd_store.resize(_rules.size());
+
+		// The anomalies depend on the bdd of the rules.
+		_anomaly_cache.clear();
+	}
+
+
 	RuleOutputOptions Firewall::make_output_options(bool show_object_name) const
 	{
 		RuleOutputOptions options;
@@ -12,7 +12,9 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "model/anomalycache.h"
 #include "model/rule.h"
+#include "model/rulebddstore.h"
 #include "model/rulelist.h"
 #include "model/table.h"
 #include "tools/interrupt.h"
@@ -75,6 +77,27 @@ namespace fwm {
 		*/
 		Table info() const;
 
+		/* Returns the bdd of a rule predicate.  The bdd is computed once and
+		 * kept in the firewall bdd store.
+		*/
+		const Bddnode& get_rule_bdd(const Rule& rule) const;
+
+		/* Returns the bdd of a rule predicate computed with the given options.
+		*/
+		const Bddnode& get_rule_bdd(const Rule& rule, const Predicate::BddOptions& options) const;
+
+		/* Removes the bdd of a rule from the firewall bdd store.
+		*/
+		void invalidate_rule_bdd(const Rule& rule);
+
+		/* Removes all bdd from the firewall bdd store.
+		*/
+		void clear_rule_bdds();
+
+		/* Returns the results of the last anomaly analysis of the acl.
+		*/
+		inline AnomalyCache& anomaly_cache() const noexcept { return _anomaly_cache; }
+
 
 	private:
 		// The firewall name
@@ -91,6 +114,12 @@ namespace fwm {
 
 		// All rules by id
 		std::map<int, Rule*> _rule_ids;
+
+		// The bdd of all rule predicates.
+		mutable RuleBddStore _bdd_store;
+
+		// The results of the last anomaly analysis.
+		mutable AnomalyCache _anomaly_cache;
 	};
 
 	using FirewallPtr = std::unique_ptr<Firewall>;
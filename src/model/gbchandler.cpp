@@ -7,20 +7,19 @@
 */
 #include "gbchandler.h"
 
-#include <cstdio>
+#include <iostream>
 #include <buddy/bdd.h>
 
 
-// Shows a 'G' when the garbage collector is running
+// Shows a 'G' when the garbage collector is running, the 'G' is written
+// on the same stream as the progress bar.
 static void analyze_gbc_hook(int pre, bddGbcStat* stat)
 {
-	if (pre == 1) {
-		fputc('G', stdout);
-		fflush(stdout);
-	}
+	if (pre == 1)
+		std::cout << 'G' << std::flush;
 }
 
-static bddgbchandler _old_handler = nullptr;
+static thread_local bddgbchandler _old_handler = nullptr;
 
 
 namespace fwm {
@@ -124,7 +124,8 @@ namespace fwm {
 		virtual std::string to_string() const override;
 
 		/**
-		 * Creates the binary decision diagram.
+		 * Creates the binary decision diagram.  The bdd is memoized, the
+		 * members of the sub-groups must not change once it is created.
 		*/
 		virtual bdd make_bdd() const override;
 
@@ -151,6 +152,9 @@ namespace fwm {
 		// Sets of direct members
 		std::set<const T*> _items;
 		std::set<const Group<T>*> _groups;
+
+		// The bdd of this group.
+		BddCache _bdd_cache;
 	};
 
 
@@ -209,16 +213,18 @@ namespace fwm {
 	template<typename T>
 	inline bdd Group<T>::make_bdd() const
 	{
-		bdd condition{ bddfalse };
-
-		for (const Member& member : _members) {
-			if (member.is_group)
-				condition = condition | member.group->make_bdd();
-			else
-				condition = condition | member.item->make_bdd();
-		}
+		return _bdd_cache.get([this]() -> bdd {
+			bdd condition{ bddfalse };
+
+			for (const Member& member : _members) {
+				if (member.is_group)
+					condition = condition | member.group->make_bdd();
+				else
+					condition = condition | member.item->make_bdd();
+			}
 
-		return condition;
+			return condition;
+		});
 	}
 
 
@@ -243,8 +249,10 @@ namespace fwm {
 	{
 		assert(item != nullptr);
 
-		if (_items.insert(item).second)
+		if (_items.insert(item).second) {
 			_members.push_back(Member{ item });
+			_bdd_cache.invalidate();
+		}
 	}
 
 
@@ -253,8 +261,10 @@ namespace fwm {
 	{
 		assert(group != nullptr);
 
-		if (_groups.insert(group).second)
+		if (_groups.insert(group).second) {
 			_members.push_back(Member{ group });
+			_bdd_cache.invalidate();
+		}
 	}
 
 
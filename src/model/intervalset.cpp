@@ -0,0 +1,158 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/intervalset.h"
+
+#include <algorithm>
+
+
+namespace fwm {
+
+	namespace {
+
+		/* Returns the value of a bit of an unsigned integer.
+		*/
+		inline bool bit_value(const uint128_t& value, int bit)
+		{
+			return bit < 64
+				? ((value.lower() >> bit) & 1) != 0
+				: ((value.upper() >> (bit - 64)) & 1) != 0;
+		}
+
+
+		/* Returns a mask having the low k bits set.
+		*/
+		inline uint128_t low_mask(int k)
+		{
+			return k >= 128 ? ~uint128_t(0) : (uint128_t(1) << k) - 1;
+		}
+
+	}
+
+
+	bdd make_range_bdd(const bvec& var, const uint128_t& lower, const uint128_t& upper)
+	{
+		const int nbits = var.bitnum();
+		bdd condition{ bddfalse };
+		uint128_t value{ lower };
+
+		while (true) {
+			// Select the largest prefix starting at value and included in
+			// the range.
+			const uint128_t span{ upper - value };
+			int k = 0;
+			while (k < nbits && !bit_value(value, k))
+				k++;
+			while (k > 0 && low_mask(k) > span)
+				k--;
+
+			bdd prefix{ bddtrue };
+			for (int bit = nbits - 1; bit >= k; bit--)
+				prefix &= bit_value(value, bit) ? var[bit] : !var[bit];
+			condition |= prefix;
+
+			const uint128_t last{ value | low_mask(k) };
+			if (last == upper)
+				break;
+			value = last + 1;
+		}
+
+		return condition;
+	}
+
+
+	IntervalSet::IntervalSet() :
+		_intervals{},
+		_normalized{ true }
+	{
+	}
+
+
+	void IntervalSet::add(const uint128_t& lower, const uint128_t& upper)
+	{
+		_intervals.push_back({ lower, upper });
+		_normalized = _intervals.size() == 1;
+	}
+
+
+	IntervalSet& IntervalSet::normalize()
+	{
+		if (_normalized)
+			return *this;
+
+		std::sort(
+			_intervals.begin(),
+			_intervals.end(),
+			[](const Interval& i1, const Interval& i2) { return i1.lower < i2.lower; }
+		);
+
+		// Merge in place the overlapping and adjacent intervals.  An interval
+		// ending at the maximum value absorbs all the following intervals.
+		const uint128_t max_value{ ~uint128_t(0) };
+		size_t last = 0;
+		for (size_t i = 1; i < _intervals.size(); i++) {
+			Interval& merged = _intervals[last];
+			const Interval& current = _intervals[i];
+
+			if (merged.upper == max_value || current.lower <= merged.upper + 1) {
+				if (current.upper > merged.upper)
+					merged.upper = current.upper;
+			}
+			else {
+				_intervals[++last] = current;
+			}
+		}
+		_intervals.resize(last + 1);
+		_normalized = true;
+
+		return *this;
+	}
+
+
+	size_t IntervalSet::find(const uint128_t& value) const
+	{
+		// Search the first interval starting after the value, the candidate
+		// is the interval that precedes it.
+		auto it = std::upper_bound(
+			_intervals.begin(),
+			_intervals.end(),
+			value,
+			[](const uint128_t& v, const Interval& i) { return v < i.lower; }
+		);
+
+		if (it == _intervals.begin())
+			return _intervals.size();
+
+		--it;
+		return value <= it->upper ? it - _intervals.begin() : _intervals.size();
+	}
+
+
+	bool IntervalSet::contains(const uint128_t& value) const
+	{
+		return find(value) < _intervals.size();
+	}
+
+
+	bool IntervalSet::contains(const uint128_t& lower, const uint128_t& upper) const
+	{
+		const size_t pos = find(lower);
+		return pos < _intervals.size() && upper <= _intervals[pos].upper;
+	}
+
+
+	bdd IntervalSet::make_bdd(const bvec& var) const
+	{
+		bdd condition{ bddfalse };
+
+		for (const Interval& interval : _intervals)
+			condition |= make_range_bdd(var, interval.lower, interval.upper);
+
+		return condition;
+	}
+
+}
@@ -0,0 +1,84 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <vector>
+#include <buddy/bvec.h>
+
+#include "tools/uint128.h"
+
+
+namespace fwm {
+
+	/* Returns a bdd testing if the variable is within [lower, upper].
+	 *
+	 * The range is decomposed in its minimal set of prefixes.  The prefix
+	 * of the value v where the k low bits are free is the conjunction of
+	 * the literals on the bits k to n-1 of the variable.
+	*/
+	bdd make_range_bdd(const bvec& var, const uint128_t& lower, const uint128_t& upper);
+
+
+	/**
+	 * An IntervalSet is a set of values of a domain represented by a sorted
+	 * list of disjoint intervals.
+	 *
+	 * Intervals are appended with add() and the set must be normalized before
+	 * being queried.  Normalization sorts the intervals and merges the
+	 * overlapping and adjacent intervals.
+	*/
+	class IntervalSet final
+	{
+	public:
+		struct Interval {
+			uint128_t lower;
+			uint128_t upper;
+		};
+
+		IntervalSet();
+
+		/* Appends the interval [lower, upper] to this set.
+		*/
+		void add(const uint128_t& lower, const uint128_t& upper);
+
+		/* Sorts and merges the intervals.
+		*/
+		IntervalSet& normalize();
+
+		/* Returns the sorted disjoint intervals.
+		*/
+		inline const std::vector<Interval>& intervals() const noexcept { return _intervals; }
+
+		/* Returns true if the set is empty.
+		*/
+		inline bool empty() const noexcept { return _intervals.empty(); }
+
+		/* Returns true if the value is in this set.
+		*/
+		bool contains(const uint128_t& value) const;
+
+		/* Returns true if all values in [lower, upper] are in this set.
+		*/
+		bool contains(const uint128_t& lower, const uint128_t& upper) const;
+
+		/* Returns a bdd testing if the variable is in this set.
+		*/
+		bdd make_bdd(const bvec& var) const;
+
+	private:
+		std::vector<Interval> _intervals;
+		bool _normalized;
+
+		/* Returns the position of the interval containing the value or the
+		 * number of intervals if no interval contains the value.
+		*/
+		size_t find(const uint128_t& value) const;
+	};
+
+}
@@ -7,6 +7,7 @@
 */
 #include <string.h>
 #include "model/mnode.h"
+#include "model/domains.h"
 #include "tools/strutil.h"
 
 namespace fwm {
@@ -54,7 +55,7 @@ namespace fwm {
 		const bdd a{ make_bdd() };
 		const bdd b{ other.make_bdd() };
 
-		return (a == b) || (bdd_imp(a, b) == bddtrue);
+		return (a == b) || bdd_subset(a, b);
 	}
 
 
@@ -69,7 +70,7 @@ namespace fwm {
 		const bdd a{ make_bdd() };
 		const bdd b{ other.make_bdd() };
 
-		return bdd_and(a, b) == bddfalse;
+		return bdd_disjoint(a, b) != 0;
 	}
 
 
@@ -99,20 +100,21 @@ namespace fwm {
 		if (a == b)
 			return MnodeRelationship::equal;
 
-		else if (bdd_imp(a, b) == bddtrue)
+		// Finds in a single traversal which assignments are only in a, only in b
+		// or in both bdds.
+		const int relation = bdd_relation(a, b);
+
+		if ((relation & BDD_REL_ONLY_LEFT) == 0)
 			return MnodeRelationship::subset;
 
-		else if (bdd_imp(b, a) == bddtrue)
+		else if ((relation & BDD_REL_ONLY_RIGHT) == 0)
 			return MnodeRelationship::superset;
 
-		else {
-			bdd intersection = a & b;
+		else if ((relation & BDD_REL_BOTH) == 0)
+			return MnodeRelationship::disjoint;
 
-			if (intersection == bddfalse)
-				return MnodeRelationship::disjoint;
-			else
-				return MnodeRelationship::overlap;
-		}
+		else
+			return MnodeRelationship::overlap;
 	}
 
 
@@ -152,4 +154,10 @@ namespace fwm {
 	{
 	}
 
+
+	unsigned int BddCache::current_epoch()
+	{
+		return Domains::get().epoch();
+	}
+
 }
@@ -264,6 +264,46 @@ namespace fwm {
 	};
 
 
+	/**
+	 * A BddCache memoizes the bdd of a model node.  The bdd is built on the
+	 * first call to get() and is built again when the epoch of the domains
+	 * changes, this happens when the bdd library is initialized or when
+	 * the model options are modified.
+	 *
+	 * The cache is not copied with the model node.
+	*/
+	class BddCache {
+	public:
+		BddCache() : _bdd{}, _epoch{ 0 } {}
+		BddCache(const BddCache&) : BddCache() {}
+		BddCache& operator=(const BddCache&) { invalidate(); return *this; }
+
+		/* Returns the cached bdd or the bdd created by the make_bdd function.
+		*/
+		template <typename F>
+		bdd get(F make_bdd) const
+		{
+			const unsigned int epoch = current_epoch();
+			if (_epoch != epoch) {
+				_bdd = make_bdd();
+				_epoch = epoch;
+			}
+
+			return _bdd;
+		}
+
+		/* Discards the cached bdd.
+		*/
+		inline void invalidate() noexcept { _epoch = 0; }
+
+	private:
+		static unsigned int current_epoch();
+
+		mutable bdd _bdd;
+		mutable unsigned int _epoch;
+	};
+
+
 	/**
 	 * Bddnode is a Mnode that encapsulates a bdd.
 	 *
@@ -274,6 +314,8 @@ namespace fwm {
 		Bddnode(const Bddnode& other);
 		Bddnode(const bdd& bddvar);
 
+		Bddnode& operator=(const Bddnode& other) = default;
+
 		inline virtual bdd make_bdd() const override { return _bdd; }
 
 	private:
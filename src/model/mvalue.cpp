@@ -12,6 +12,7 @@
 #include <string>
 
 #include "model/domains.h"
+#include "model/intervalset.h"
 
 
 namespace fwm {
@@ -31,21 +32,10 @@ namespace fwm {
 			// Interval range == domain range
 			return bddtrue;
 		}
-		else {
-			const bvec& var = _domain.var();
-
-			if (_range->is_singleton()) {
-				// lower and upper bounds are equal, we test var == lbound
-				return bvec_equ(var, _range->lbound());
-			}
-			else {
-				// we test lbound <= var <= ubound
-				const bdd condition1{ bvec_lte(_range->lbound(), var) };
-				const bdd condition2{ bvec_lte(var, _range->ubound()) };
-
-				return bdd_and(condition1, condition2);
-			}
-		}
+
+		return _bdd_cache.get([this]() -> bdd {
+			return make_range_bdd(_domain.var(), _range->lower_value(), _range->upper_value());
+		});
 	}
 
 
@@ -51,6 +51,11 @@ namespace fwm {
 		*/
 		inline const Range& range() const noexcept { return *_range; }
 
+		/**
+		 * Returns the domain of this MValue.
+		*/
+		inline const Domain& domain() const noexcept { return _domain; }
+
 	private:
 		// The domain to which the range of values is associated.
 		const Domain& _domain;
@@ -61,6 +66,9 @@ namespace fwm {
 		// Is true when the range covers the whole domain.  This flag is
 		// used to simplify the bdd evaluation to bddtrue.
 		const bool _all;
+
+		// The bdd of this value.
+		BddCache _bdd_cache;
 	};
 
 	using MvaluePtr = std::unique_ptr<const Mvalue>;
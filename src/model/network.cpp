@@ -46,15 +46,20 @@ namespace fwm {
 		_src_zone_cache.set(SrcZone::any());
 		_dst_zone_cache.set(DstZone::any());
 
+		// Only the address domains of the ip model are allocated, the source
+		// and destination domains are declared together.
+		Domains& domains = Domains::get();
 		switch (_model_config.ip_model) {
 		case IPAddressModel::IP4Model:
 			_src_addr_cache.set(SrcAddress::any4(IPAddressModel::IP4Model));
 			_dst_addr_cache.set(DstAddress::any4(IPAddressModel::IP4Model));
+			domains.use(DomainType::SrcAddress4);
 			break;
 
 		case IPAddressModel::IP6Model:
 			_src_addr_cache.set(SrcAddress::any6(IPAddressModel::IP6Model));
 			_dst_addr_cache.set(DstAddress::any6(IPAddressModel::IP6Model));
+			domains.use(DomainType::SrcAddress6);
 			break;
 
 		default:
@@ -63,6 +68,8 @@ namespace fwm {
 
 			_dst_addr_cache.set(DstAddress::any4(IPAddressModel::IP64Model));
 			_dst_addr_cache.set(DstAddress::any6(IPAddressModel::IP64Model));
+			domains.use(DomainType::SrcAddress4);
+			domains.use(DomainType::SrcAddress6);
 		}
 
 		_svc_cache.set(Service::any());
@@ -132,6 +139,46 @@ namespace fwm {
 	}
 
 
+	void Network::clear_rule_bdds()
+	{
+		// The bdds memoized in the model nodes depend on the model options.
+		Domains::get().next_epoch();
+
+		for (auto& firewall : _firewalls)
+			firewall.second->clear_rule_bdds();
+	}
+
+
+	void Network::reserve_application_id(const std::string& name)
+	{
+		get_id(_app_id_gen, DomainType::Application, name);
+	}
+
+
+	void Network::reserve_user_id(const std::string& name)
+	{
+		get_id(_user_id_gen, DomainType::User, name);
+	}
+
+
+	void Network::reserve_url_id(const std::string& name)
+	{
+		get_id(_url_id_gen, DomainType::Url, name);
+	}
+
+
+	uint32_t Network::get_id(IdGenerator& id_gen, DomainType dt, const std::string& name)
+	{
+		const uint32_t id = id_gen.get_id(name);
+
+		// If the variable of the domain is extended, the epoch changes and the
+		// bdds of the rules of all networks are rebuilt.
+		Domains::get().reserve(dt, id);
+
+		return id;
+	}
+
+
 	const SrcZone* Network::get_src_zone(const std::string& name) const
 	{
 		return _src_zone_cache.get(name);
@@ -243,7 +290,7 @@ namespace fwm {
 		const SrcZone* zone{ get_src_zone(name) };
 
 		if (!zone) {
-			const uint32_t zone_id = _zone_id_gen.get_id(name);
+			const uint32_t zone_id = get_id(_zone_id_gen, DomainType::SrcZone, name);
 
 			// Create and register a new source zone
 			zone = _src_zone_cache.set(SrcZone::create(name, zone_id));
@@ -258,7 +305,7 @@ namespace fwm {
 		const DstZone* zone { get_dst_zone(name) };
 
 		if (!zone) {
-			const uint32_t zone_id = _zone_id_gen.get_id(name);
+			const uint32_t zone_id = get_id(_zone_id_gen, DomainType::SrcZone, name);
 
 			// Create and register a new destination zone
 			zone = _dst_zone_cache.set(DstZone::create(name, zone_id));
@@ -470,7 +517,7 @@ namespace fwm {
 		const Application* application{ get_application(name, use_app_svc) };
 
 		if (!application) {
-			const uint32_t app_id = _app_id_gen.get_id(name);
+			const uint32_t app_id = get_id(_app_id_gen, DomainType::Application, name);
 
 			// Register all default services for this application.
 			ServiceGroupPtr service_group{ new ServiceGroup("$appsvc") };
@@ -527,7 +574,7 @@ namespace fwm {
 		const User* user{ get_user(name) };
 
 		if (!user) {
-			const int32_t user_id = _user_id_gen.get_id(name);
+			const int32_t user_id = get_id(_user_id_gen, DomainType::User, name);
 
 			// Create and register a new user
 			user= _user_cache.set(User::create(name, user_id, model_options));
@@ -574,7 +621,7 @@ namespace fwm {
 		const Url* url{ get_url(name) };
 
 		if (!url) {
-			const int32_t url_id = _url_id_gen.get_id(name);
+			const int32_t url_id = get_id(_url_id_gen, DomainType::Url, name);
 
 			// Create and register a new url
 			url = _url_cache.set(Url::create(name, url_id, model_options));
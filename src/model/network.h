@@ -56,6 +56,11 @@ namespace fwm {
 		*/
 		Table create_info_table() const;
 
+		/* Removes all rule bdd from the firewalls of this network.  This method must
+		 * be called when the model options are modified.
+		*/
+		void clear_rule_bdds();
+
 		const SrcZone* get_src_zone(const std::string& name) const;
 		const DstZone* get_dst_zone(const std::string& name) const;
 
@@ -103,6 +108,14 @@ namespace fwm {
 		const Url* register_url(const std::string& name);
 		const UrlGroup* register_url_group(const std::string& name, const std::vector<std::string>& members);
 
+		/* Assigns an id to an application, a user or an url before the object
+		 * is registered.  The ids are allocated in the order of the calls, the
+		 * members of a group reserved one after the other get contiguous ids.
+		*/
+		void reserve_application_id(const std::string& name);
+		void reserve_user_id(const std::string& name);
+		void reserve_url_id(const std::string& name);
+
 		ModelOptions model_options;
 
 	private:
@@ -155,6 +168,11 @@ namespace fwm {
 		IdGenerator _url_id_gen;
 
 		const Service* register_appsvc(const std::string& name, const std::string& service_definition);
+
+		/* Returns the id of a zone, application, user or url name and extends
+		 * the variable of the domain if needed.
+		*/
+		uint32_t get_id(IdGenerator& id_gen, DomainType dt, const std::string& name);
 	};
 
 }
@@ -95,7 +95,7 @@ namespace fwm {
 
 		for (const auto& rule : _acl) {
 			// Is the traffic defined by the test predicate accepted by this rule ?
-			if (test_bdd.is_subset(Bddnode(rule->predicate().make_bdd(bdd_options)))) {
+			if (test_bdd.is_subset(rule->predicate_bdd(bdd_options))) {
 				return std::make_pair(rule->action() == RuleAction::ALLOW, rule);
 			}
 		}
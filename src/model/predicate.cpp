@@ -300,6 +300,20 @@ namespace fwm {
 	}
 
 
+	bdd Predicate::make_symmetrical_bdd(const std::function<bdd(const bdd&)>& swap) const
+	{
+		return
+			swap(_src_zones->make_bdd()) &
+			swap(_dst_zones->make_bdd()) &
+			swap(src_addresses_bdd()) &
+			swap(dst_addresses_bdd()) &
+			(_services->is_app_services() ? bddtrue : _services->make_bdd()) &
+			_applications->make_bdd() &
+			_users->make_bdd() &
+			_urls->make_bdd();
+	}
+
+
 	bdd Predicate::make_bdd(BddOptions options) const
 	{
 		bdd output_bdd =
@@ -8,6 +8,7 @@
 #pragma once
 #include "global.h"
 
+#include <functional>
 #include <memory>
 
 #include "model/address.h"
@@ -154,6 +155,16 @@ namespace fwm {
 		 */
 		Predicate* symmetrical() const;
 
+		/**
+		 * Creates the bdd of the symmetrical predicate of this predicate.
+		 *
+		 * Only the zone and the address bdds are passed to the swap function, the
+		 * other bdds are combined unchanged.  This avoids swapping the variables
+		 * of the whole predicate bdd and lets the caller memoize the swapped
+		 * groups shared by several rules.
+		 */
+		bdd make_symmetrical_bdd(const std::function<bdd(const bdd&)>& swap) const;
+
 		/**
 		 * Returns a reference to all services configured on a rule.
 		*/
@@ -0,0 +1,246 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/profiler.h"
+
+#include <algorithm>
+#include <ctime>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "fmt/core.h"
+
+
+namespace fwm {
+
+	namespace {
+
+		const char* PHASE_NAMES[] = {
+			"other",
+			"make_bdd",
+			"State::update",
+			"check_rule",
+			"find_is_subset",
+			"find_other_is_subset",
+			"find_overlaping",
+			"find_covering",
+			"swap_src_dst",
+			"compare_policies"
+		};
+
+		constexpr size_t PHASE_COUNT = sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]);
+
+
+		std::string to_ms(std::chrono::steady_clock::duration duration)
+		{
+			return fmt::format("{:.3f}",
+				std::chrono::duration_cast<std::chrono::microseconds>(duration).count() * 1.0e-3);
+		}
+
+
+		std::string to_rate(size_t hits, size_t misses)
+		{
+			return hits + misses == 0 ? "" : fmt::format("{:.2f}", hits * 100.0 / (hits + misses));
+		}
+
+	}
+
+
+	Profiler::Scope::Scope(Profiler* profiler, Phase phase) :
+		_profiler{ profiler }
+	{
+		if (_profiler)
+			_profiler->enter(phase);
+	}
+
+
+	Profiler::Scope::~Scope()
+	{
+		if (_profiler)
+			_profiler->leave();
+	}
+
+
+	Profiler::Profiler() :
+		_counters(PHASE_COUNT, Counters{ 0, clock::duration::zero(), 0, 0, 0, 0 }),
+		_phases{},
+		_mark_time{},
+		_mark_stats{},
+		_start_time{},
+		_stop_time{},
+		_start_stats{},
+		_stop_stats{},
+		_merged_gbcnum{ 0 },
+		_merged_gbctime{ 0 },
+		_merged_produced{ 0 },
+		_merged_peaknodes{ 0 }
+	{
+	}
+
+
+	void Profiler::start()
+	{
+		_phases.clear();
+		_phases.push_back(Phase::Other);
+
+		bdd_resetpeak();
+		bdd_stats(&_start_stats);
+		bdd_cachestats(&_mark_stats);
+
+		_start_time = clock::now();
+		_mark_time = _start_time;
+	}
+
+
+	void Profiler::stop()
+	{
+		charge();
+		_phases.clear();
+
+		_stop_time = clock::now();
+		bdd_stats(&_stop_stats);
+	}
+
+
+	void Profiler::enter(Phase phase)
+	{
+		charge();
+
+		_phases.push_back(phase);
+		_counters[static_cast<size_t>(phase)].calls++;
+	}
+
+
+	void Profiler::leave()
+	{
+		charge();
+
+		if (_phases.size() > 1)
+			_phases.pop_back();
+	}
+
+
+	void Profiler::charge()
+	{
+		if (_phases.empty())
+			return;
+
+		const clock::time_point now = clock::now();
+		bddCacheStat stats;
+		bdd_cachestats(&stats);
+
+		Counters& counters = _counters[static_cast<size_t>(_phases.back())];
+		counters.time += now - _mark_time;
+		counters.apply_calls += stats.applyCalls - _mark_stats.applyCalls;
+		counters.ite_calls += stats.iteCalls - _mark_stats.iteCalls;
+		counters.op_hits += stats.opHit - _mark_stats.opHit;
+		counters.op_misses += stats.opMiss - _mark_stats.opMiss;
+
+		_mark_time = now;
+		_mark_stats = stats;
+	}
+
+
+	void Profiler::write_counters(std::ostream& output) const
+	{
+		output
+			<< _stop_stats.gbcnum - _start_stats.gbcnum
+			<< ' ' << _stop_stats.gbctime - _start_stats.gbctime
+			<< ' ' << _stop_stats.produced - _start_stats.produced
+			<< ' ' << _stop_stats.peaknodes;
+
+		for (const Counters& counters : _counters) {
+			output
+				<< ' ' << counters.calls
+				<< ' ' << counters.time.count()
+				<< ' ' << counters.apply_calls
+				<< ' ' << counters.ite_calls
+				<< ' ' << counters.op_hits
+				<< ' ' << counters.op_misses;
+		}
+	}
+
+
+	void Profiler::merge_counters(std::istream& input)
+	{
+		int gbcnum;
+		long gbctime;
+		size_t produced;
+		int peaknodes;
+		if (!(input >> gbcnum >> gbctime >> produced >> peaknodes))
+			throw std::runtime_error("internal error : invalid profiler counters");
+
+		_merged_gbcnum += gbcnum;
+		_merged_gbctime += gbctime;
+		_merged_produced += produced;
+		_merged_peaknodes = std::max(_merged_peaknodes, peaknodes);
+
+		for (Counters& counters : _counters) {
+			Counters other;
+			clock::rep time;
+			if (!(input >> other.calls >> time >> other.apply_calls >> other.ite_calls >> other.op_hits >> other.op_misses))
+				throw std::runtime_error("internal error : invalid profiler counters");
+
+			counters.calls += other.calls;
+			counters.time += clock::duration(time);
+			counters.apply_calls += other.apply_calls;
+			counters.ite_calls += other.ite_calls;
+			counters.op_hits += other.op_hits;
+			counters.op_misses += other.op_misses;
+		}
+	}
+
+
+	Table Profiler::phases_table() const
+	{
+		Table table{ {"phase", "calls", "time (ms)", "apply", "ite", "cache hit %"} };
+
+		for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+			const Counters& counters = _counters[phase];
+			if (counters.time == clock::duration::zero() && counters.calls == 0)
+				continue;
+
+			Row& row = table.add_row();
+			row.cell(0).append(PHASE_NAMES[phase]);
+			if (phase != static_cast<size_t>(Phase::Other))
+				row.cell(1).append(counters.calls);
+			row.cell(2).append(to_ms(counters.time));
+			row.cell(3).append(counters.apply_calls);
+			row.cell(4).append(counters.ite_calls);
+			row.cell(5).append(to_rate(counters.op_hits, counters.op_misses));
+		}
+
+		return table;
+	}
+
+
+	Table Profiler::summary_table() const
+	{
+		Table table{ {"counter", "value"} };
+
+		auto add_row = [&table](const std::string& name, const std::string& value) {
+			Row& row = table.add_row();
+			row.cell(0).append(name);
+			row.cell(1).append(value);
+		};
+
+		add_row("elapsed time (ms)", to_ms(_stop_time - _start_time));
+		add_row("garbage collections", std::to_string(_stop_stats.gbcnum - _start_stats.gbcnum + _merged_gbcnum));
+		add_row("garbage collection time (ms)", fmt::format("{:.3f}",
+			(_stop_stats.gbctime - _start_stats.gbctime + _merged_gbctime) * 1000.0 / CLOCKS_PER_SEC));
+		add_row("peak nodes in use", std::to_string(_stop_stats.peaknodes));
+		if (_merged_peaknodes > 0)
+			add_row("peak nodes in use by a worker", std::to_string(_merged_peaknodes));
+		add_row("allocated nodes", std::to_string(_stop_stats.nodenum));
+		add_row("nodes produced", std::to_string(_stop_stats.produced - _start_stats.produced + _merged_produced));
+
+		return table;
+	}
+
+}
@@ -0,0 +1,131 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+#include <buddy/bdd.h>
+
+#include "model/table.h"
+
+
+namespace fwm {
+
+	/**
+	 * A Profiler measures the time spent and the bdd operations executed in
+	 * each phase of an analysis.  Phases can be nested, the time and the
+	 * operations of a nested phase are not counted in the enclosing phase.
+	 * The garbage collections and the peak node usage are measured for the
+	 * whole analysis.
+	*/
+	class Profiler final
+	{
+	public:
+		enum class Phase {
+			Other,                  // time spent outside any phase
+			MakeBdd,                // bdd of the rule predicates
+			StateUpdate,            // State::update
+			CheckRule,              // classification of a rule
+			FindIsSubset,           // explanation searches
+			FindOtherIsSubset,
+			FindOverlapping,
+			FindCovering,
+			SwapSrcDst,             // symmetrical bdd of the rules
+			PolicyCompare           // allowed and denied packets of the compared policies
+		};
+
+		/**
+		 * A Scope marks a block of code executed in a phase.  Nothing is
+		 * measured when the profiler is null.
+		*/
+		class Scope final
+		{
+		public:
+			Scope(Profiler* profiler, Phase phase);
+			~Scope();
+
+		private:
+			Profiler* const _profiler;
+		};
+
+		Profiler();
+
+		/* Starts and stops the measures.
+		*/
+		void start();
+		void stop();
+
+		/* Writes the counters of the phases, of the garbage collections and
+		 * the peak node usage to a stream.  The counters are read back with
+		 * merge_counters.
+		*/
+		void write_counters(std::ostream& output) const;
+
+		/* Adds the counters written by another profiler, the counters of the
+		 * worker processes of a parallel analysis are merged this way.  The
+		 * largest peak node usage of the merged profilers is kept.  The
+		 * function throws a runtime_error if the counters are invalid.
+		*/
+		void merge_counters(std::istream& input);
+
+		/* Returns a table showing the counters of each phase.
+		*/
+		Table phases_table() const;
+
+		/* Returns a table showing the global counters.
+		*/
+		Table summary_table() const;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		struct Counters {
+			size_t calls;
+			clock::duration time;
+			size_t apply_calls;
+			size_t ite_calls;
+			size_t op_hits;
+			size_t op_misses;
+		};
+
+		// Counters of each phase
+		std::vector<Counters> _counters;
+
+		// Stack of the active phases
+		std::vector<Phase> _phases;
+
+		// Time and bdd statistics when the current phase was entered
+		// or resumed.
+		clock::time_point _mark_time;
+		bddCacheStat _mark_stats;
+
+		// Global measures
+		clock::time_point _start_time;
+		clock::time_point _stop_time;
+		bddStat _start_stats;
+		bddStat _stop_stats;
+
+		// Garbage collections, nodes produced and largest peak node usage
+		// of the merged profilers
+		int _merged_gbcnum;
+		long _merged_gbctime;
+		size_t _merged_produced;
+		int _merged_peaknodes;
+
+		void enter(Phase phase);
+		void leave();
+
+		/* Adds the time and the bdd operations since the last mark to
+		 * the current phase.
+		*/
+		void charge();
+	};
+
+}
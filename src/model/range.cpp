@@ -21,7 +21,9 @@ namespace fwm {
 
 	bool Range::operator==(const Range& other) const
 	{
-		return ((lbound() == other.lbound()) == bddtrue) && ((ubound() == other.ubound()) == bddtrue);
+		return _nbits == other._nbits
+			&& lower_value() == other.lower_value()
+			&& upper_value() == other.upper_value();
 	}
 
 }
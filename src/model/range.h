@@ -13,6 +13,8 @@
 
 #include <buddy/bvec.h>
 
+#include "tools/uint128.h"
+
 
 namespace fwm {
 
@@ -41,6 +43,16 @@ namespace fwm {
 		*/
 		virtual bvec ubound() const = 0;
 
+		/**
+		 * Returns the lower bound of this range as an unsigned integer.
+		*/
+		virtual uint128_t lower_value() const = 0;
+
+		/**
+		 * Returns the upper bound of this range as an unsigned integer.
+		*/
+		virtual uint128_t upper_value() const = 0;
+
 		/**
 		 * Returns true when the lower bound equal the upper bound.
 		*/
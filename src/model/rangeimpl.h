@@ -30,6 +30,9 @@ namespace fwm {
 		virtual bvec lbound() const override;
 		virtual bvec ubound() const override;
 
+		virtual uint128_t lower_value() const override;
+		virtual uint128_t upper_value() const override;
+
 		virtual bool is_singleton() const override;
 		virtual bool is_power_of_2() const override;
 		virtual Range* clone() const override;
@@ -81,6 +84,20 @@ namespace fwm {
 	};
 
 
+	template<typename T>
+	inline uint128_t RangeImpl<T>::lower_value() const
+	{
+		return uint128_t(_lbound);
+	};
+
+
+	template<typename T>
+	inline uint128_t RangeImpl<T>::upper_value() const
+	{
+		return uint128_t(_ubound);
+	};
+
+
 	template<typename T>
 	inline bool RangeImpl<T>::is_singleton() const
 	{
@@ -29,18 +29,20 @@ namespace fwm {
 		_id{ id },
 		_status{ status },
 		_action{ action },
-		_predicate{ predicate }
+		_predicate{ predicate },
+		_index{ 0 }
 	{
 	}
 
 
-	Rule::Rule(const Rule& other) :
+	Rule::Rule(Firewall& firewall, const Rule& other) :
 		_name{ other._name },
 		_id{ other._id },
-		_firewall{ other._firewall },
+		_firewall{ firewall },
 		_status{ other._status },
 		_action{ other._action },
-		_predicate{ new Predicate(*other._predicate) }
+		_predicate{ new Predicate(*other._predicate) },
+		_index{ 0 }
 	{
 	}
 
@@ -79,8 +81,8 @@ namespace fwm {
 
 	MnodeRelationship Rule::compare(const Rule& other) const
 	{
-		const Bddnode this_bdd{ predicate().make_bdd() };
-		const Bddnode other_bdd{ other.predicate().make_bdd() };
+		const Bddnode& this_bdd{ predicate_bdd() };
+		const Bddnode& other_bdd{ other.predicate_bdd() };
 
 		return this_bdd
 				.negate_if(action() == RuleAction::DENY)
@@ -166,13 +168,26 @@ namespace fwm {
 
 	bool Rule::is_deny_all() const noexcept
 	{
-		return action() == RuleAction::DENY && predicate().is_any();
+		return action() == RuleAction::DENY && predicate_bdd().is_any();
+	}
+
+
+	const Bddnode& Rule::predicate_bdd() const
+	{
+		return _firewall.get_rule_bdd(*this);
+	}
+
+
+	const Bddnode& Rule::predicate_bdd(const Predicate::BddOptions& options) const
+	{
+		return _firewall.get_rule_bdd(*this, options);
 	}
 
 
 	void Rule::set_rule_status(RuleStatus status)
 	{
 		_status = status;
+		_firewall.invalidate_rule_bdd(*this);
 	}
 
 }
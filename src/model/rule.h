@@ -61,7 +61,10 @@ namespace fwm {
 	{
 	public:
 		Rule(Firewall& firewall, const std::string& name, int id, RuleStatus status, RuleAction action, const Predicate* predicate);
-		Rule(const Rule& other);
+
+		/* Copies a rule into the given firewall.
+		*/
+		Rule(Firewall& firewall, const Rule& other);
 
 		/* Writes a a representation of this rule to the given table row.
 		*/
@@ -95,11 +98,26 @@ namespace fwm {
 		*/
 		inline const Predicate& predicate() const noexcept { return *_predicate; }
 
+		/* Returns the bdd of the rule predicate.  The bdd is kept in the
+		 * firewall bdd store.
+		*/
+		const Bddnode& predicate_bdd() const;
+
+		/* Returns the bdd of the rule predicate computed with the given options.
+		*/
+		const Bddnode& predicate_bdd(const Predicate::BddOptions& options) const;
+
+		/* Returns the index of this rule in the firewall.
+		*/
+		inline size_t index() const noexcept { return _index; }
+
 		/* Returns true if the rule is configured to use the default application services.
 		*/
 		bool is_default_app_svc() const;
 
-		/* Returns true if this is a deny all rule.
+		/* Returns true if this is a deny all rule.  As Mnode::is_any, the check
+		 * compares the bdd of the predicate with bddtrue, the bdd is taken from
+		 * the rule bdd store of the firewall instead of being rebuilt.
 		*/
 		bool is_deny_all() const noexcept;
 
@@ -127,6 +145,11 @@ namespace fwm {
 		// users that is denied or accepted by this rule.  This rule owns the predicate
 		// object.
 		const PredicatePtr _predicate;
+
+		// The index of this rule in the firewall, allocated when the rule is added.
+		size_t _index;
+
+		friend class Firewall;
 	};
 
 	using RulePtr = std::unique_ptr<Rule>;
@@ -0,0 +1,119 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/rulebddstore.h"
+
+#include <stdexcept>
+
+#include "model/domains.h"
+#include "model/rule.h"
+
+
+namespace fwm {
+
+	RuleBddStore::RuleBddStore() :
+		_size{ 0 },
+		_epoch{ 0 },
+		_predicates{},
+		_views{}
+	{
+	}
+
+
+	void RuleBddStore::resize(size_t size)
+	{
+		_size = size;
+
+		_predicates.resize(size, Slot{ false, Bddnode() });
+		for (auto& view : _views)
+			view.second.resize(size, Slot{ false, Bddnode() });
+	}
+
+
+	const Bddnode& RuleBddStore::get(const Rule& rule)
+	{
+		check_epoch();
+		Slot& s = slot(_predicates, rule);
+
+		if (!s.valid) {
+			s.node = Bddnode(rule.predicate().make_bdd());
+			s.valid = true;
+		}
+
+		return s.node;
+	}
+
+
+	const Bddnode& RuleBddStore::get(const Rule& rule, const Predicate::BddOptions& options)
+	{
+		check_epoch();
+		auto it = _views.find(options_key(options));
+		if (it == _views.end()) {
+			it = _views.insert(std::make_pair(options_key(options), Slots())).first;
+			it->second.resize(_size, Slot{ false, Bddnode() });
+		}
+
+		Slot& s = slot(it->second, rule);
+
+		if (!s.valid) {
+			s.node = Bddnode(rule.predicate().make_bdd(options));
+			s.valid = true;
+		}
+
+		return s.node;
+	}
+
+
+	void RuleBddStore::invalidate(const Rule& rule)
+	{
+		slot(_predicates, rule) = Slot{ false, Bddnode() };
+		for (auto& view : _views)
+			slot(view.second, rule) = Slot{ false, Bddnode() };
+	}
+
+
+	void RuleBddStore::clear()
+	{
+		_size = 0;
+		_predicates.clear();
+		_views.clear();
+	}
+
+
+	RuleBddStore::Slot& RuleBddStore::slot(Slots& slots, const Rule& rule)
+	{
+		if (rule.index() >= slots.size())
+			throw std::runtime_error("internal error : rule not in bdd store");
+
+		return slots[rule.index()];
+	}
+
+
+	void RuleBddStore::check_epoch()
+	{
+		// The variables of the domains have been extended or the model options
+		// have changed, possibly by another network.
+		const unsigned int epoch = Domains::get().epoch();
+		if (_epoch != epoch) {
+			_predicates.assign(_size, Slot{ false, Bddnode() });
+			_views.clear();
+			_epoch = epoch;
+		}
+	}
+
+
+	unsigned int RuleBddStore::options_key(const Predicate::BddOptions& options)
+	{
+		unsigned int key = 0;
+
+		for (const Predicate::BddOption option : options.options())
+			key |= 1u << static_cast<int>(option);
+
+		return key;
+	}
+
+}
@@ -0,0 +1,92 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <map>
+#include <vector>
+
+#include "model/mnode.h"
+#include "model/predicate.h"
+
+
+namespace fwm {
+
+	// forward declaration.
+	class Rule;
+
+	/**
+	 * A RuleBddStore keeps the binary decision diagrams of the rule predicates
+	 * of a firewall.
+	 *
+	 * The store is indexed by the rule index allocated by the firewall when the
+	 * rule is added.  A bdd is computed the first time it is requested and is
+	 * kept until the rule is invalidated, the store is cleared or the epoch of
+	 * the domains changes.  References returned by the store remain valid as
+	 * long as the store is not resized and the epoch does not change.
+	*/
+	class RuleBddStore final
+	{
+	public:
+		RuleBddStore();
+
+		/**
+		 * Resizes the store to hold the bdd of 'size' rules.
+		*/
+		void resize(size_t size);
+
+		/**
+		 * Returns the bdd of the rule predicate.
+		*/
+		const Bddnode& get(const Rule& rule);
+
+		/**
+		 * Returns the bdd of the rule predicate computed with the given options.
+		*/
+		const Bddnode& get(const Rule& rule, const Predicate::BddOptions& options);
+
+		/**
+		 * Removes the bdd of the given rule from the store.
+		*/
+		void invalidate(const Rule& rule);
+
+		/**
+		 * Removes all bdd from the store.
+		*/
+		void clear();
+
+	private:
+		struct Slot {
+			bool valid;
+			Bddnode node;
+		};
+
+		using Slots = std::vector<Slot>;
+
+		// Number of rules in the store.
+		size_t _size;
+
+		// Epoch of the domains when the bdds were computed.
+		unsigned int _epoch;
+
+		// The bdd of all rule predicates.
+		Slots _predicates;
+
+		// The bdd of all rule predicates computed with specific options.  The
+		// key is a bit mask of the options.
+		std::map<unsigned int, Slots> _views;
+
+		Slot& slot(Slots& slots, const Rule& rule);
+
+		/* Removes all bdds if they were computed in another epoch.
+		*/
+		void check_epoch();
+		static unsigned int options_key(const Predicate::BddOptions& options);
+	};
+
+}
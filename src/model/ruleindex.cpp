@@ -0,0 +1,241 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "model/ruleindex.h"
+
+#include <algorithm>
+
+#include "model/address.h"
+#include "model/service.h"
+#include "model/zone.h"
+
+
+namespace fwm {
+
+	namespace {
+
+		template <class T>
+		void add_zones(std::vector<uint64_t>& ids, bool& any, const Group<T>& zones)
+		{
+			for (const T* zone : zones.items()) {
+				const Range& range = zone->value().range();
+
+				if (range.is_singleton())
+					ids.push_back(range.lower_value().lower());
+				else
+					any = true;
+			}
+
+			std::sort(ids.begin(), ids.end());
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		}
+
+	}
+
+
+	bool RuleIndex::ZoneSet::overlaps(const ZoneSet& other) const
+	{
+		if (any || other.any)
+			return true;
+
+		auto it1 = ids.begin();
+		auto it2 = other.ids.begin();
+		while (it1 != ids.end() && it2 != other.ids.end()) {
+			if (*it1 == *it2)
+				return true;
+			else if (*it1 < *it2)
+				++it1;
+			else
+				++it2;
+		}
+
+		return false;
+	}
+
+
+	void RuleIndex::FieldHulls::add(int key, const uint128_t& lower, const uint128_t& upper)
+	{
+		auto it = hulls.find(key);
+
+		if (it == hulls.end()) {
+			hulls.insert(std::make_pair(key, std::make_pair(lower, upper)));
+		}
+		else {
+			if (lower < it->second.first)
+				it->second.first = lower;
+			if (upper > it->second.second)
+				it->second.second = upper;
+		}
+	}
+
+
+	bool RuleIndex::FieldHulls::overlaps(const FieldHulls& other, bool cross_keys) const
+	{
+		if (any || other.any)
+			return true;
+
+		for (const auto& hull : hulls) {
+			for (const auto& other_hull : other.hulls) {
+				if (hull.first != other_hull.first) {
+					// Values of different keys are encoded in different domains,
+					// they always overlap when cross_keys is true.
+					if (cross_keys)
+						return true;
+				}
+				else if (hull.second.first <= other_hull.second.second &&
+						 other_hull.second.first <= hull.second.second) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+
+	RuleIndex::RuleIndex(const RuleList& rules) :
+		_rules{ rules.begin(), rules.end() },
+		_positions{},
+		_summaries{},
+		_src_zone_rules{},
+		_any_src_zone_rules{},
+		_empty_rules{}
+	{
+		_summaries.reserve(_rules.size());
+
+		for (size_t position = 0; position < _rules.size(); position++) {
+			const Rule* rule = _rules[position];
+			const Predicate& predicate = rule->predicate();
+
+			_positions[rule] = position;
+
+			RuleSummary summary{
+				ZoneSet{ false, {} },
+				ZoneSet{ false, {} },
+				FieldHulls{ predicate.negate_src_addresses(), {} },
+				FieldHulls{ predicate.negate_dst_addresses(), {} },
+				FieldHulls{ predicate.services().is_app_services(), {} }
+			};
+
+			// Zones
+			add_zones(summary.src_zones.ids, summary.src_zones.any, predicate.src_zones());
+			add_zones(summary.dst_zones.ids, summary.dst_zones.any, predicate.dst_zones());
+
+			// Addresses, the key is the size of the address.
+			if (!summary.src_addresses.any) {
+				for (const SrcAddress* address : predicate.src_addresses().items()) {
+					const Range& range = address->value().range();
+					summary.src_addresses.add(range.nbits(), range.lower_value(), range.upper_value());
+				}
+			}
+
+			if (!summary.dst_addresses.any) {
+				for (const DstAddress* address : predicate.dst_addresses().items()) {
+					const Range& range = address->value().range();
+					summary.dst_addresses.add(range.nbits(), range.lower_value(), range.upper_value());
+				}
+			}
+
+			// Services, the key is the protocol.
+			if (!summary.services.any) {
+				for (const Service* service : predicate.services().items()) {
+					if (service->protocol().pt() == ProtocolType::ANY) {
+						summary.services.any = true;
+						break;
+					}
+
+					const Range& range = service->ports().range();
+					summary.services.add(
+						static_cast<int>(service->protocol().pt()),
+						range.lower_value(),
+						range.upper_value()
+					);
+				}
+			}
+
+			// Update the inverted list of source zones.
+			if (summary.src_zones.any) {
+				_any_src_zone_rules.push_back(position);
+			}
+			else {
+				for (const uint64_t id : summary.src_zones.ids)
+					_src_zone_rules[id].push_back(position);
+			}
+
+			if (rule->predicate_bdd().is_none())
+				_empty_rules.push_back(position);
+
+			_summaries.push_back(summary);
+		}
+	}
+
+
+	RuleList RuleIndex::candidates(const Rule& rule, bool include_empty) const
+	{
+		const size_t position = _positions.at(&rule);
+		const RuleSummary& summary = _summaries[position];
+
+		std::vector<size_t> selected;
+
+		auto select = [this, position, &summary, &selected](const std::vector<size_t>& others) {
+			for (const size_t other : others) {
+				if (other >= position)
+					break;
+
+				if (may_overlap(summary, _summaries[other]))
+					selected.push_back(other);
+			}
+		};
+
+		if (summary.src_zones.any) {
+			for (size_t other = 0; other < position; other++) {
+				if (may_overlap(summary, _summaries[other]))
+					selected.push_back(other);
+			}
+		}
+		else {
+			for (const uint64_t id : summary.src_zones.ids) {
+				auto it = _src_zone_rules.find(id);
+				if (it != _src_zone_rules.end())
+					select(it->second);
+			}
+
+			select(_any_src_zone_rules);
+		}
+
+		if (include_empty) {
+			for (const size_t other : _empty_rules) {
+				if (other >= position)
+					break;
+
+				selected.push_back(other);
+			}
+		}
+
+		// Restore the order of the rule list.
+		std::sort(selected.begin(), selected.end());
+		selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+
+		RuleList rules(selected.size());
+		for (const size_t other : selected)
+			rules.push_back(_rules[other]);
+
+		return rules;
+	}
+
+
+	bool RuleIndex::may_overlap(const RuleSummary& summary1, const RuleSummary& summary2) const
+	{
+		return
+			summary1.src_zones.overlaps(summary2.src_zones) &&
+			summary1.dst_zones.overlaps(summary2.dst_zones) &&
+			summary1.src_addresses.overlaps(summary2.src_addresses, true) &&
+			summary1.dst_addresses.overlaps(summary2.dst_addresses, true) &&
+			summary1.services.overlaps(summary2.services, false);
+	}
+
+}
@@ -0,0 +1,93 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "model/rule.h"
+#include "model/rulelist.h"
+#include "tools/uint128.h"
+
+
+namespace fwm {
+
+	/**
+	 * A RuleIndex selects the candidate rules that may overlap a given rule.
+	 *
+	 * The index is built from a summary of the zones, the addresses and the
+	 * services of each rule.  Source zones are indexed in an inverted list,
+	 * destination zones, addresses and services are compared using their zone
+	 * ids and the hulls of their intervals.  Other criteria are ignored.
+	 *
+	 * The selection is exact-safe : it may return rules that do not overlap
+	 * the given rule but never drops a rule that overlaps it.  An exact bdd
+	 * test must be applied on the candidates.
+	*/
+	class RuleIndex final
+	{
+	public:
+		explicit RuleIndex(const RuleList& rules);
+
+		/**
+		 * Returns the rules preceding 'rule' that may overlap it.  Rules having
+		 * an empty predicate are added when 'include_empty' is true.  Rules are
+		 * returned in the order of the rule list.
+		*/
+		RuleList candidates(const Rule& rule, bool include_empty) const;
+
+	private:
+		// A set of zone ids.
+		struct ZoneSet {
+			bool any;
+			std::vector<uint64_t> ids;
+
+			bool overlaps(const ZoneSet& other) const;
+		};
+
+		// The hull of the intervals of a field for each key (an address
+		// size or a protocol).
+		struct FieldHulls {
+			bool any;
+			std::map<int, std::pair<uint128_t, uint128_t>> hulls;
+
+			void add(int key, const uint128_t& lower, const uint128_t& upper);
+			bool overlaps(const FieldHulls& other, bool cross_keys) const;
+		};
+
+		struct RuleSummary {
+			ZoneSet src_zones;
+			ZoneSet dst_zones;
+			FieldHulls src_addresses;
+			FieldHulls dst_addresses;
+			FieldHulls services;
+		};
+
+		// All rules
+		std::vector<const Rule*> _rules;
+
+		// Position of the rules in the list
+		std::unordered_map<const Rule*, size_t> _positions;
+
+		// Summary of each rule
+		std::vector<RuleSummary> _summaries;
+
+		// Rules by source zone id and rules with any source zone.
+		std::unordered_map<uint64_t, std::vector<size_t>> _src_zone_rules;
+		std::vector<size_t> _any_src_zone_rules;
+
+		// Rules having an empty predicate.
+		std::vector<size_t> _empty_rules;
+
+		bool may_overlap(const RuleSummary& summary1, const RuleSummary& summary2) const;
+	};
+
+}
@@ -82,7 +82,9 @@ namespace fwm {
 
 	bdd Service::make_bdd() const
 	{
-		return _protocol->make_bdd() & _ports->make_bdd();
+		return _bdd_cache.get([this]() -> bdd {
+			return _protocol->make_bdd() & _ports->make_bdd();
+		});
 	}
 
 
@@ -85,6 +85,9 @@ namespace fwm {
 
 		// The ports.
 		const std::unique_ptr<const Ports> _ports;
+
+		// The bdd of this service.
+		BddCache _bdd_cache;
 	};
 
 
@@ -13,7 +13,6 @@
 namespace fwm {
 
 	State::State(const Predicate& predicate) :
-		_predicate{ predicate },
 		_I{ predicate.make_bdd() },
 		_A{},
 		_D{},
@@ -32,8 +32,6 @@ namespace fwm {
 		const StateVar& processed(RuleAction action) const noexcept;
 
 	private:
-		const Predicate& _predicate;
-
 		StateVar _I;
 		StateVar _A;
 		StateVar _D;
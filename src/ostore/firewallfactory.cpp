@@ -9,7 +9,11 @@
 
 #include <cstdio>
 #include <fstream>
+#include <list>
+#include <set>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "model/ipaddress.h"
 #include "model/firewall.h"
@@ -25,6 +29,70 @@
 
 namespace fos {
 
+	namespace {
+
+		/* Returns the pools used by the rules, the pools are returned in the order
+		 * of the object store.
+		*/
+		template <typename P, typename G>
+		std::list<const P*> used_pools(
+			const std::list<const P*>& pools,
+			const std::vector<fos::RuleObject>& rules,
+			const std::vector<std::string> fos::RuleObject::* field,
+			G get_pool)
+		{
+			std::set<const P*> used;
+			for (const fos::RuleObject& rule : rules) {
+				for (const std::string& name : rule.*field) {
+					const P* pool = get_pool(name);
+					if (pool)
+						used.insert(pool);
+				}
+			}
+
+			std::list<const P*> used_list;
+			for (const P* pool : pools) {
+				if (used.count(pool) > 0)
+					used_list.push_back(pool);
+			}
+
+			return used_list;
+		}
+
+
+		/* Reserves the ids of the objects of the root pools in the order of the
+		 * pool hierarchy.
+		*/
+		template <typename P, typename R, typename F>
+		void reserve_ids(const std::list<const P*>& pools, R resolve_pool, F reserve_id)
+		{
+			// A root pool is not a member of another pool.
+			std::set<std::string> nested_pools;
+			for (const P* pool : pools) {
+				for (const std::string& member : pool->members())
+					nested_pools.insert(member);
+			}
+
+			std::list<std::string> unresolved;
+			for (const P* pool : pools) {
+				if (nested_pools.count(pool->name()) > 0)
+					continue;
+
+				try {
+					for (const auto& member : resolve_pool(pool, unresolved)) {
+						if (!member.is_pool)
+							reserve_id(member.object->name());
+					}
+				}
+				catch (const std::runtime_error&) {
+					// A loop in the pool is reported when a rule uses it.
+				}
+			}
+		}
+
+	}
+
+
 	FirewallFactory::FirewallFactory(const fos::ObjectStore& object_store, const LoaderConfig& loader_config) :
 		_object_store{ object_store },
 		_loader_config{ loader_config },
@@ -53,12 +121,19 @@ namespace fos {
 
 	LoaderStatus FirewallFactory::load_rules(Firewall& fw, PolicyReader& reader)
 	{
-		fos::RuleObject rule{};
+		// The rows are read first to know which pools are used by the rules.
+		std::vector<fos::RuleObject> rules;
+		fos::RuleObject row{};
+		while (reader.next_row(row))
+			rules.push_back(row);
 
 		// Initialize the loader status
 		LoaderStatus status;
 
-		while (reader.next_row(rule)) {
+		// Assign the ids of the pool members before they are used by the rules.
+		reserve_pool_ids(fw.network(), rules);
+
+		for (const fos::RuleObject& rule : rules) {
 			if (add_rule(fw, rule, status))
 				status.loaded_count++;
 			else
@@ -74,6 +149,49 @@ namespace fos {
 	};
 
 
+	void FirewallFactory::reserve_pool_ids(Network& nw, const std::vector<fos::RuleObject>& rules) const
+	{
+		reserve_ids(
+			used_pools(
+				_object_store.query_application_pools("*"),
+				rules,
+				&fos::RuleObject::applications,
+				[this](const std::string& name) { return _object_store.get_application_pool(name); }
+			),
+			[this](const ApplicationPool* pool, std::list<std::string>& unresolved) {
+				return _object_store.resolve_application_pool(pool, unresolved);
+			},
+			[&nw](const std::string& name) { nw.reserve_application_id(name); }
+		);
+
+		reserve_ids(
+			used_pools(
+				_object_store.query_user_pools("*"),
+				rules,
+				&fos::RuleObject::users,
+				[this](const std::string& name) { return _object_store.get_user_pool(name); }
+			),
+			[this](const UserPool* pool, std::list<std::string>& unresolved) {
+				return _object_store.resolve_user_pool(pool, unresolved);
+			},
+			[&nw](const std::string& name) { nw.reserve_user_id(name); }
+		);
+
+		reserve_ids(
+			used_pools(
+				_object_store.query_url_pools("*"),
+				rules,
+				&fos::RuleObject::urls,
+				[this](const std::string& name) { return _object_store.get_url_pool(name); }
+			),
+			[this](const UrlPool* pool, std::list<std::string>& unresolved) {
+				return _object_store.resolve_url_pool(pool, unresolved);
+			},
+			[&nw](const std::string& name) { nw.reserve_url_id(name); }
+		);
+	}
+
+
 	SrcAddressGroupPtr FirewallFactory::build_src_address_group(Network& nw, const fos::RuleObject& rule, LoaderStatus& status)
 	{
 		SrcAddressGroupPtr src_address_group{ std::make_unique<SrcAddressGroup>("$root") };
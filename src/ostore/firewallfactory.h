@@ -10,6 +10,7 @@
 
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "ostore/ostoreconfig.h"
 #include "ostore/objectstore.h"
@@ -93,6 +94,15 @@ namespace fos {
 		*/
 		LoaderStatus load_rules(Firewall& fw, PolicyReader& reader);
 
+		/* Assigns the ids of the applications, users and urls members of the pools
+		 * used by the rules.  The pools are walked from the roots of the pool
+		 * hierarchy, the members of a pool get contiguous ids and the bdd of the
+		 * pool is built from a few ranges of ids instead of many scattered ids.
+		 * The objects of the unused pools are not registered and don't widen the
+		 * application, user and url domains.
+		*/
+		void reserve_pool_ids(Network& nw, const std::vector<fos::RuleObject>& rules) const;
+
 		/* Builds the source address group used by the given rule.
 		*/
 		SrcAddressGroupPtr build_src_address_group(Network& nw, const fos::RuleObject& rule, LoaderStatus& status);
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <buddy/bdd.h>
 #include "model/ipaddress.h"
 #include "tools/strutil.h"
 #include "fmt/core.h"
@@ -17,10 +18,25 @@
 
 namespace fos {
 
+	std::string page_mode_name(int page_mode)
+	{
+		switch (page_mode) {
+		case BDD_PAGES_TRANSPARENT:
+			return "transparent";
+
+		case BDD_PAGES_HUGE:
+			return "huge";
+
+		default:
+			return "default";
+		}
+	}
+
+
 	OstoreConfig::OstoreConfig() :
 		logger_config{ false, "" },
 		model_config{},
-		buddy_config{ 10000, 1000 },
+		buddy_config{ 10000, 4000000, 20, 0, 1000, 0, 0, VariableOrder::Domain, ReorderMethod::None, BDD_PAGES_DEFAULT },
 		loader_config{ { ';' }, false },
 		writer_config{ ';' },
 		fqdn_resolver_config{ true, true, "rulan.fqdn" }
@@ -61,7 +77,52 @@ namespace fos {
 		const auto buddy_table = config_table.get_table("buddy");
 		if (buddy_table) {
 			load_int(*buddy_table, "nodes", buddy_config.node_size);
+			load_int(*buddy_table, "max-increase", buddy_config.max_increase);
+			load_int(*buddy_table, "min-free-nodes", buddy_config.min_free_nodes);
+			if (buddy_config.min_free_nodes > 100)
+				throw_invalid_parameter("min-free-nodes", "value out of range");
+			load_int(*buddy_table, "max-memory", buddy_config.max_memory);
 			load_int(*buddy_table, "cache", buddy_config.cache_size);
+			load_int(*buddy_table, "min-cache", buddy_config.min_cache_size);
+			load_int(*buddy_table, "max-cache", buddy_config.max_cache_size);
+
+			std::string variable_order;
+			load_string(*buddy_table, "order", variable_order);
+
+			if (rat::iequal(variable_order, "domain") || rat::iequal(variable_order, ""))
+				buddy_config.variable_order = VariableOrder::Domain;
+			else if (rat::iequal(variable_order, "interleaved"))
+				buddy_config.variable_order = VariableOrder::Interleaved;
+			else if (rat::iequal(variable_order, "zones-first"))
+				buddy_config.variable_order = VariableOrder::ZonesFirst;
+			else
+				throw_invalid_parameter("order", fmt::format("'{}' is an invalid variable order", variable_order));
+
+			std::string reorder_method;
+			load_string(*buddy_table, "reorder", reorder_method);
+
+			if (rat::iequal(reorder_method, "none") || rat::iequal(reorder_method, ""))
+				buddy_config.reorder_method = ReorderMethod::None;
+			else if (rat::iequal(reorder_method, "sift"))
+				buddy_config.reorder_method = ReorderMethod::Sift;
+			else if (rat::iequal(reorder_method, "win2"))
+				buddy_config.reorder_method = ReorderMethod::Win2;
+			else if (rat::iequal(reorder_method, "win3"))
+				buddy_config.reorder_method = ReorderMethod::Win3;
+			else
+				throw_invalid_parameter("reorder", fmt::format("'{}' is an invalid reorder method", reorder_method));
+
+			std::string page_mode;
+			load_string(*buddy_table, "pages", page_mode);
+
+			if (rat::iequal(page_mode, "default") || rat::iequal(page_mode, ""))
+				buddy_config.page_mode = BDD_PAGES_DEFAULT;
+			else if (rat::iequal(page_mode, "transparent"))
+				buddy_config.page_mode = BDD_PAGES_TRANSPARENT;
+			else if (rat::iequal(page_mode, "huge"))
+				buddy_config.page_mode = BDD_PAGES_HUGE;
+			else
+				throw_invalid_parameter("pages", fmt::format("'{}' is an invalid page mode", page_mode));
 		}
 
 		const auto loader_table = config_table.get_table("loader");
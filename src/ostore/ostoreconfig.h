@@ -9,6 +9,7 @@
 #include "global.h"
 
 #include <string>
+#include "model/domains.h"
 #include "model/mconfig.h"
 
 #define CPPTOML_NO_RTTI
@@ -32,10 +33,38 @@ namespace fos {
 		// initial number of nodes in the BuDDy node table.
 		int node_size;
 
+		// maximum number of nodes added when the node table grows.
+		int max_increase;
+
+		// percentage of free nodes after a garbage collection under which
+		// the node table grows.
+		int min_free_nodes;
+
+		// maximum memory of the node table in megabytes, 0 if unlimited.
+		int max_memory;
+
 		// number of cache entries.
 		int cache_size;
+
+		// bounds of the number of cache entries when the size adapts to the
+		// hit rate, the size is fixed if max_cache_size is 0.
+		int min_cache_size;
+		int max_cache_size;
+
+		// initial order of the bdd variables.
+		VariableOrder variable_order;
+
+		// dynamic reordering of the bdd variables.
+		ReorderMethod reorder_method;
+
+		// pages backing the node table and the caches (BDD_PAGES_xxx).
+		int page_mode;
 	};
 
+	/* Returns the name of a page mode as used in the configuration file.
+	*/
+	std::string page_mode_name(int page_mode);
+
 	class CsvReaderConfig {
 	public:
 		// list delimiter in .csv file
@@ -0,0 +1,458 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "ostore/policygenerator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "fmt/core.h"
+
+
+namespace fos {
+
+	namespace {
+
+		std::ofstream open_file(const std::string& filename)
+		{
+			std::ofstream file{ filename, std::ofstream::out | std::ofstream::trunc };
+			if (!file.good())
+				throw std::runtime_error(fmt::format("can't create file '{}'", filename));
+
+			return file;
+		}
+
+
+		void close_file(std::ofstream& file, const std::string& filename)
+		{
+			file.close();
+			if (file.fail())
+				throw std::runtime_error(fmt::format("unable to write file '{}'", filename));
+		}
+
+
+		void check_ratio(int value, const char* name)
+		{
+			if (value < 0 || value > 100)
+				throw std::runtime_error(fmt::format("{} must be a percentage", name));
+		}
+
+	}
+
+
+	PolicyGeneratorConfig::PolicyGeneratorConfig() :
+		rule_count{ 1000 },
+		zone_count{ 8 },
+		group_depth{ 2 },
+		overlap_ratio{ 20 },
+		negate_ratio{ 2 },
+		ipv6_ratio{ 0 },
+		app_ratio{ 10 },
+		seed{ 1 },
+		csv_list_delimiter{ ';' }
+	{
+	}
+
+
+	std::vector<std::string> PolicyFiles::filenames() const
+	{
+		return { addresses, address_groups, services, service_groups, applications, rules, script };
+	}
+
+
+	PolicyGenerator::PolicyGenerator(const PolicyGeneratorConfig& config) :
+		_config{ config },
+		_random{ config.seed },
+		_addresses{},
+		_address_groups{},
+		_services{},
+		_service_groups{},
+		_applications{}
+	{
+		if (_config.rule_count < 1)
+			throw std::runtime_error("the number of rules must be positive");
+		if (_config.zone_count < 1)
+			throw std::runtime_error("the number of zones must be positive");
+		if (_config.group_depth < 0 || _config.group_depth > 10)
+			throw std::runtime_error("the group depth must be between 0 and 10");
+
+		check_ratio(_config.overlap_ratio, "overlap ratio");
+		check_ratio(_config.negate_ratio, "negate ratio");
+		check_ratio(_config.ipv6_ratio, "ipv6 ratio");
+		check_ratio(_config.app_ratio, "application ratio");
+	}
+
+
+	PolicyFiles PolicyGenerator::generate(const std::string& prefix)
+	{
+		const PolicyFiles files{
+			prefix + "-addr.csv",
+			prefix + "-addrg.csv",
+			prefix + "-svc.csv",
+			prefix + "-svcg.csv",
+			prefix + "-app.csv",
+			prefix + "-rules.csv",
+			prefix + ".txt"
+		};
+
+		// Restart the sequence, successive calls generate the same policy.
+		_random.seed(_config.seed);
+		_addresses.clear();
+		_address_groups.clear();
+		_services.clear();
+		_service_groups.clear();
+		_applications.clear();
+
+		write_addresses(files.addresses);
+		write_address_groups(files.address_groups);
+		write_services(files.services);
+		write_service_groups(files.service_groups);
+		write_applications(files.applications);
+		write_rules(files.rules);
+		write_script(files);
+
+		return files;
+	}
+
+
+	void PolicyGenerator::write_addresses(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "name,type,address\n";
+
+		// Addresses are created in pairs, a subnet followed by a host of
+		// this subnet.
+		const int subnet_count = std::max(8, _config.rule_count / 4);
+		for (int subnet = 0; subnet < subnet_count; subnet++) {
+			const int high = (subnet / 256) % 256;
+			const int low = subnet % 256;
+			const int host = 1 + next(254);
+
+			std::string net_address;
+			std::string host_address;
+			if (chance(_config.ipv6_ratio)) {
+				net_address = fmt::format("2001:db8:{:x}:{:x}::/64", high, low);
+				host_address = fmt::format("2001:db8:{:x}:{:x}::{:x}", high, low, host);
+			}
+			else {
+				net_address = fmt::format("10.{}.{}.0/24", high, low);
+				host_address = fmt::format("10.{}.{}.{}", high, low, host);
+			}
+
+			const std::string net_name = fmt::format("net{}", subnet);
+			const std::string host_name = fmt::format("host{}", subnet);
+			file << net_name << ",ipmask," << net_address << '\n';
+			file << host_name << ",ipmask," << host_address << '\n';
+
+			_addresses.push_back(net_name);
+			_addresses.push_back(host_name);
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_address_groups(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "name,members\n";
+
+		// The first level contains addresses, each other level contains groups
+		// of the previous level and sometimes an address.
+		std::vector<std::string> previous_level;
+		int group_count = std::max(2, static_cast<int>(_addresses.size()) / 16);
+
+		for (int level = 1; level <= _config.group_depth; level++) {
+			std::vector<std::string> current_level;
+
+			for (int index = 0; index < group_count; index++) {
+				std::vector<std::string> members;
+
+				if (level == 1) {
+					const int member_count = 2 + next(4);
+					for (int member = 0; member < member_count; member++)
+						members.push_back(_addresses[next(static_cast<int>(_addresses.size()))]);
+				}
+				else {
+					const int member_count = 2 + next(2);
+					for (int member = 0; member < member_count; member++)
+						members.push_back(previous_level[next(static_cast<int>(previous_level.size()))]);
+					if (chance(50))
+						members.push_back(_addresses[next(static_cast<int>(_addresses.size()))]);
+				}
+
+				std::sort(members.begin(), members.end());
+				members.erase(std::unique(members.begin(), members.end()), members.end());
+
+				const std::string name = fmt::format("grp{}-{}", level, index);
+				file << name << ',' << join(members) << '\n';
+				current_level.push_back(name);
+			}
+
+			_address_groups.insert(_address_groups.end(), current_level.begin(), current_level.end());
+			previous_level = std::move(current_level);
+			group_count = std::max(2, group_count / 2);
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_services(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "name,protoport\n";
+
+		const int service_count = 64;
+		for (int index = 0; index < service_count; index++) {
+			const std::string name = fmt::format("svc{}", index);
+			const char* protocol = index % 4 == 3 ? "udp" : "tcp";
+			const int port = 1000 + 16 * index;
+
+			// One service out of eight is a port range.
+			if (index % 8 == 7)
+				file << name << ',' << protocol << '/' << port << '-' << port + 15 << '\n';
+			else
+				file << name << ',' << protocol << '/' << port << '\n';
+
+			_services.push_back(name);
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_service_groups(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "name,members\n";
+
+		const int group_count = 8;
+		for (int index = 0; index < group_count; index++) {
+			std::vector<std::string> members;
+			const int member_count = 2 + next(3);
+			for (int member = 0; member < member_count; member++)
+				members.push_back(_services[next(static_cast<int>(_services.size()))]);
+
+			std::sort(members.begin(), members.end());
+			members.erase(std::unique(members.begin(), members.end()), members.end());
+
+			const std::string name = fmt::format("svcgrp{}", index);
+			file << name << ',' << join(members) << '\n';
+			_service_groups.push_back(name);
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_applications(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "name,protoport\n";
+
+		const int application_count = 16;
+		for (int index = 0; index < application_count; index++) {
+			const std::string name = fmt::format("app{}", index);
+			const int port = 20000 + 10 * index;
+
+			file << name << ",tcp/" << port << ";udp/" << port + 1 << '\n';
+			_applications.push_back(name);
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_rules(const std::string& filename)
+	{
+		std::ofstream file = open_file(filename);
+		file << "id,action,src.zone,src.addr,src.negate,dst.zone,dst.addr,dst.negate,svc,app\n";
+
+		std::vector<RuleSpec> rules;
+		rules.reserve(_config.rule_count);
+
+		for (int id = 1; id <= _config.rule_count; id++) {
+			if (!rules.empty() && chance(_config.overlap_ratio))
+				rules.push_back(derive_rule(rules[next(static_cast<int>(rules.size()))]));
+			else
+				rules.push_back(make_rule());
+
+			const RuleSpec& rule = rules.back();
+			file
+				<< id << ','
+				<< (rule.deny ? "deny" : "allow") << ','
+				<< join(rule.src_zones) << ','
+				<< join(rule.src_addresses) << ','
+				<< (rule.src_negate ? "true" : "false") << ','
+				<< join(rule.dst_zones) << ','
+				<< join(rule.dst_addresses) << ','
+				<< (rule.dst_negate ? "true" : "false") << ','
+				<< join(rule.services) << ','
+				<< join(rule.applications) << '\n';
+		}
+
+		close_file(file, filename);
+	}
+
+
+	void PolicyGenerator::write_script(const PolicyFiles& files)
+	{
+		std::ofstream file = open_file(files.script);
+
+		file << "ostore clear\n";
+		file << "ostore load address " << files.addresses << '\n';
+		file << "ostore load address-group " << files.address_groups << '\n';
+		file << "ostore load service " << files.services << '\n';
+		file << "ostore load service-group " << files.service_groups << '\n';
+		file << "ostore load application " << files.applications << '\n';
+		file << "firewall load " << files.rules << '\n';
+
+		close_file(file, files.script);
+	}
+
+
+	PolicyGenerator::RuleSpec PolicyGenerator::make_rule()
+	{
+		RuleSpec rule;
+
+		rule.deny = chance(20);
+		rule.src_zones = pick_zones();
+		rule.src_addresses = pick_addresses();
+		rule.dst_zones = pick_zones();
+		rule.dst_addresses = pick_addresses();
+
+		// A negated list of addresses never contains "any".
+		rule.src_negate = rule.src_addresses[0] != "any" && chance(_config.negate_ratio);
+		rule.dst_negate = rule.dst_addresses[0] != "any" && chance(_config.negate_ratio);
+
+		if (chance(_config.app_ratio)) {
+			rule.services = { "app-default" };
+			rule.applications = { _applications[next(static_cast<int>(_applications.size()))] };
+		}
+		else {
+			if (chance(5))
+				rule.services = { "any" };
+			else if (chance(10))
+				rule.services = { _service_groups[next(static_cast<int>(_service_groups.size()))] };
+			else
+				rule.services = { _services[next(static_cast<int>(_services.size()))] };
+
+			rule.applications = { "any" };
+		}
+
+		return rule;
+	}
+
+
+	PolicyGenerator::RuleSpec PolicyGenerator::derive_rule(const RuleSpec& rule)
+	{
+		RuleSpec derived = rule;
+
+		switch (next(5)) {
+		case 0:
+			// narrower destination
+			if (rule.dst_addresses[0] == "any")
+				derived.dst_addresses = { _addresses[next(static_cast<int>(_addresses.size()))] };
+			else
+				derived.dst_addresses = { rule.dst_addresses[next(static_cast<int>(rule.dst_addresses.size()))] };
+			break;
+
+		case 1:
+			// wider source
+			derived.src_addresses = { "any" };
+			derived.src_negate = false;
+			break;
+
+		case 2:
+			// opposite action
+			derived.deny = !rule.deny;
+			break;
+
+		case 3:
+			// narrower or wider service
+			if (rule.applications[0] == "any")
+				derived.services = { chance(50) ? "any" : _services[next(static_cast<int>(_services.size()))] };
+			else
+				derived.applications = { "any" };
+			break;
+
+		default:
+			// same match
+			break;
+		}
+
+		return derived;
+	}
+
+
+	std::vector<std::string> PolicyGenerator::pick_zones()
+	{
+		if (chance(10))
+			return { "any" };
+
+		std::vector<std::string> zones{ fmt::format("z{}", next(_config.zone_count)) };
+		if (_config.zone_count > 1 && chance(20)) {
+			const std::string zone = fmt::format("z{}", next(_config.zone_count));
+			if (zone != zones[0])
+				zones.push_back(zone);
+		}
+
+		return zones;
+	}
+
+
+	std::vector<std::string> PolicyGenerator::pick_addresses()
+	{
+		if (chance(10))
+			return { "any" };
+
+		std::vector<std::string> addresses;
+		const int address_count = 1 + (chance(30) ? next(3) : 0);
+		for (int index = 0; index < address_count; index++) {
+			if (!_address_groups.empty() && chance(30))
+				addresses.push_back(_address_groups[next(static_cast<int>(_address_groups.size()))]);
+			else
+				addresses.push_back(_addresses[next(static_cast<int>(_addresses.size()))]);
+		}
+
+		std::sort(addresses.begin(), addresses.end());
+		addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+		return addresses;
+	}
+
+
+	int PolicyGenerator::next(int n)
+	{
+		// The raw output of the engine is used because the algorithms of the
+		// standard distributions depend on the library implementation.
+		return static_cast<int>(_random() % static_cast<uint32_t>(n));
+	}
+
+
+	bool PolicyGenerator::chance(int percent)
+	{
+		return next(100) < percent;
+	}
+
+
+	std::string PolicyGenerator::join(const std::vector<std::string>& values) const
+	{
+		std::string result;
+
+		for (const std::string& value : values) {
+			if (!result.empty())
+				result += _config.csv_list_delimiter;
+			result += value;
+		}
+
+		return result;
+	}
+
+}
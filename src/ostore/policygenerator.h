@@ -0,0 +1,140 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace fos {
+
+	class PolicyGeneratorConfig {
+	public:
+		PolicyGeneratorConfig();
+
+		// Number of rules in the policy.
+		int rule_count;
+
+		// Number of zones.
+		int zone_count;
+
+		// Nesting depth of the address groups, no address group is generated
+		// when the depth is 0.
+		int group_depth;
+
+		// Percentage of rules derived from a previous rule (same objects with
+		// a narrower or a wider match, or the opposite action).
+		int overlap_ratio;
+
+		// Percentage of rules with negated source or destination addresses.
+		int negate_ratio;
+
+		// Percentage of IPv6 addresses.
+		int ipv6_ratio;
+
+		// Percentage of rules matching applications.
+		int app_ratio;
+
+		// Seed of the pseudo random generator.
+		uint32_t seed;
+
+		// List delimiter in .csv files.
+		char csv_list_delimiter;
+	};
+
+
+	/**
+	 * The files written by the policy generator.
+	*/
+	struct PolicyFiles {
+		std::string addresses;
+		std::string address_groups;
+		std::string services;
+		std::string service_groups;
+		std::string applications;
+		std::string rules;
+
+		// A script loading all files with the ostore and firewall load commands.
+		std::string script;
+
+		/* Returns all filenames.
+		*/
+		std::vector<std::string> filenames() const;
+	};
+
+
+	/**
+	 * A PolicyGenerator writes a synthetic policy and its objects in the csv
+	 * formats read by the object store and by the policy reader.  The policy
+	 * only depends on the configuration, the same seed always produces the
+	 * same files.
+	*/
+	class PolicyGenerator final
+	{
+	public:
+		explicit PolicyGenerator(const PolicyGeneratorConfig& config);
+
+		/* Generates the policy in files named <prefix>-<kind>.csv.
+		 *
+		 * @throws a runtime error if the configuration is invalid or if
+		 *         a file can't be written.
+		*/
+		PolicyFiles generate(const std::string& prefix);
+
+	private:
+		struct RuleSpec {
+			bool deny;
+			std::vector<std::string> src_zones;
+			std::vector<std::string> src_addresses;
+			bool src_negate;
+			std::vector<std::string> dst_zones;
+			std::vector<std::string> dst_addresses;
+			bool dst_negate;
+			std::vector<std::string> services;
+			std::vector<std::string> applications;
+		};
+
+		const PolicyGeneratorConfig _config;
+		std::mt19937 _random;
+
+		// Names of the generated objects
+		std::vector<std::string> _addresses;
+		std::vector<std::string> _address_groups;
+		std::vector<std::string> _services;
+		std::vector<std::string> _service_groups;
+		std::vector<std::string> _applications;
+
+		void write_addresses(const std::string& filename);
+		void write_address_groups(const std::string& filename);
+		void write_services(const std::string& filename);
+		void write_service_groups(const std::string& filename);
+		void write_applications(const std::string& filename);
+		void write_rules(const std::string& filename);
+		void write_script(const PolicyFiles& files);
+
+		RuleSpec make_rule();
+		RuleSpec derive_rule(const RuleSpec& rule);
+
+		std::vector<std::string> pick_zones();
+		std::vector<std::string> pick_addresses();
+
+		/* Returns a number in [0, n[.
+		*/
+		int next(int n);
+
+		/* Returns true with a probability of percent/100.
+		*/
+		bool chance(int percent);
+
+		std::string join(const std::vector<std::string>& values) const;
+	};
+
+}
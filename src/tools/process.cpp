@@ -0,0 +1,227 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#include "tools/process.h"
+
+#include <stdexcept>
+
+#if defined(RA_OS_LINUX)
+  #include <cerrno>
+  #include <csignal>
+  #include <cstring>
+  #include <poll.h>
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+
+namespace rat {
+
+#if defined(RA_OS_LINUX)
+
+	namespace {
+
+		struct ChildProcess {
+			pid_t pid;
+			int fd;
+			std::string output;
+		};
+
+
+		/* Writes the whole buffer to a file descriptor.
+		*/
+		bool write_all(int fd, const std::string& buffer)
+		{
+			const char* data = buffer.data();
+			size_t remaining = buffer.size();
+
+			while (remaining > 0) {
+				const ssize_t count = ::write(fd, data, remaining);
+				if (count < 0) {
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+
+				data += count;
+				remaining -= static_cast<size_t>(count);
+			}
+
+			return true;
+		}
+
+
+		/* Executes a task in a child process.  This function never returns.
+		*/
+		void run_child(const f_task& task, int fd)
+		{
+			int status;
+			std::string result;
+
+			try {
+				result = task();
+				status = 0;
+			}
+			catch (const std::exception& e) {
+				result = e.what();
+				status = 1;
+			}
+			catch (...) {
+				result = "unexpected error";
+				status = 1;
+			}
+
+			if (!write_all(fd, result))
+				status = 2;
+			::close(fd);
+
+			// Terminate immediately, the child must not run the destructors
+			// of the objects owned by the parent process.
+			::_exit(status);
+		}
+
+
+		/* Kills and waits for all children.
+		*/
+		void kill_children(std::vector<ChildProcess>& children)
+		{
+			for (ChildProcess& child : children) {
+				if (child.fd >= 0) {
+					::close(child.fd);
+					child.fd = -1;
+				}
+				::kill(child.pid, SIGKILL);
+			}
+
+			for (ChildProcess& child : children)
+				::waitpid(child.pid, nullptr, 0);
+
+			children.clear();
+		}
+
+	}
+
+
+	std::vector<std::string> run_tasks(const std::vector<f_task>& tasks, f_interrupt_cb interrupt_cb)
+	{
+		std::vector<ChildProcess> children;
+		children.reserve(tasks.size());
+
+		// Start all tasks.
+		for (const f_task& task : tasks) {
+			int fds[2];
+			if (::pipe(fds) != 0) {
+				kill_children(children);
+				throw std::runtime_error(std::string("pipe failed : ") + std::strerror(errno));
+			}
+
+			const pid_t pid = ::fork();
+			if (pid < 0) {
+				const int error = errno;
+				::close(fds[0]);
+				::close(fds[1]);
+				kill_children(children);
+				throw std::runtime_error(std::string("fork failed : ") + std::strerror(error));
+			}
+			else if (pid == 0) {
+				// Child process
+				::close(fds[0]);
+				for (const ChildProcess& child : children)
+					::close(child.fd);
+
+				run_child(task, fds[1]);
+			}
+
+			// Parent process
+			::close(fds[1]);
+			children.push_back(ChildProcess{ pid, fds[0], std::string() });
+		}
+
+		// Collect the output of all tasks.
+		size_t open_count = children.size();
+		std::vector<struct pollfd> poll_fds(children.size());
+
+		while (open_count > 0) {
+			if (interrupt_cb()) {
+				kill_children(children);
+				throw interrupt_error("** interrupted **");
+			}
+
+			for (size_t i = 0; i < children.size(); i++) {
+				poll_fds[i].fd = children[i].fd;
+				poll_fds[i].events = POLLIN;
+				poll_fds[i].revents = 0;
+			}
+
+			const int ready = ::poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), 100);
+			if (ready < 0 && errno != EINTR) {
+				kill_children(children);
+				throw std::runtime_error(std::string("poll failed : ") + std::strerror(errno));
+			}
+
+			for (size_t i = 0; ready > 0 && i < children.size(); i++) {
+				if (poll_fds[i].fd < 0 || poll_fds[i].revents == 0)
+					continue;
+
+				char buffer[65536];
+				const ssize_t count = ::read(children[i].fd, buffer, sizeof(buffer));
+				if (count > 0) {
+					children[i].output.append(buffer, static_cast<size_t>(count));
+				}
+				else if (count == 0 || errno != EINTR) {
+					::close(children[i].fd);
+					children[i].fd = -1;
+					open_count--;
+				}
+			}
+		}
+
+		// Wait for the termination of all tasks.
+		std::vector<std::string> results;
+		results.reserve(children.size());
+
+		std::string error;
+		for (ChildProcess& child : children) {
+			int status = 0;
+			while (::waitpid(child.pid, &status, 0) < 0 && errno == EINTR)
+				;
+
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				if (error.empty())
+					error = child.output.empty() ? "task terminated abnormally" : child.output;
+			}
+
+			results.push_back(std::move(child.output));
+		}
+
+		if (!error.empty())
+			throw std::runtime_error(error);
+
+		return results;
+	}
+
+#else
+
+	std::vector<std::string> run_tasks(const std::vector<f_task>& tasks, f_interrupt_cb interrupt_cb)
+	{
+		std::vector<std::string> results;
+		results.reserve(tasks.size());
+
+		for (const f_task& task : tasks) {
+			if (interrupt_cb())
+				throw interrupt_error("** interrupted **");
+
+			results.push_back(task());
+		}
+
+		return results;
+	}
+
+#endif
+
+}
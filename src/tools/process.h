@@ -0,0 +1,40 @@
+/*!
+* This file is part of RulesAnalyzer
+*
+* Copyright (C) 2024 Jean-Noel Meurisse
+* SPDX-License-Identifier: GPL-3.0-only
+*
+*/
+#pragma once
+#include "global.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "tools/interrupt.h"
+
+
+namespace rat {
+
+	/* A task returns its result as a string.
+	*/
+	using f_task = std::function<std::string()>;
+
+	/* Executes all tasks and returns their results in the order of the tasks.
+	 *
+	 * On Linux, each task is executed in a forked child process and the result
+	 * is sent back to the parent process through a pipe.  All tasks run
+	 * concurrently.  A child process works on a copy of the parent memory,
+	 * changes made by a task are therefore not visible from the caller.
+	 *
+	 * On other operating systems, the tasks are executed sequentially in the
+	 * current process.
+	 *
+	 * The function throws a runtime_error if a task fails and an
+	 * interrupt_error if the interrupt callback returns true while waiting
+	 * for the tasks.
+	*/
+	std::vector<std::string> run_tasks(const std::vector<f_task>& tasks, f_interrupt_cb interrupt_cb);
+
+}
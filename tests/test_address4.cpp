@@ -224,3 +224,32 @@ TEST(DstAddress4Test, bdd) {
 	EXPECT_EQ(a5->compare(*a4), MnodeRelationship::overlap);
 	EXPECT_EQ(a4->compare(*a5), MnodeRelationship::overlap);
 }
+
+
+TEST(DstAddress4Test, group_bdd) {
+	using namespace fwm;
+
+	std::unique_ptr<const DstAddress> a1{ DstAddress::create("a1", "10.0.3.0-10.0.3.1", IPAddressModel::IP4Model, true) };
+	std::unique_ptr<const DstAddress> a2{ DstAddress::create("a2", "10.0.3.2", IPAddressModel::IP4Model, true) };
+	std::unique_ptr<const DstAddress> a3{ DstAddress::create("a3", "10.0.3.3-10.0.3.15", IPAddressModel::IP4Model, true) };
+	std::unique_ptr<const DstAddress> a4{ DstAddress::create("a4", "10.0.3.8/30", IPAddressModel::IP4Model, true) };
+	std::unique_ptr<const DstAddress> a5{ DstAddress::create("a5", "192.168.1.0/24", IPAddressModel::IP4Model, true) };
+
+	DstAddressGroupPtr g1 = std::make_unique<DstAddressGroup>("g1");
+	g1->add_member(a5.get());
+	g1->add_member(a3.get());
+
+	DstAddressGroupPtr g2 = std::make_unique<DstAddressGroup>("g2");
+	g2->add_member(a4.get());
+	g2->add_member(a2.get());
+	g2->add_member(a1.get());
+	g2->add_member(g1.get());
+
+	// The merged intervals give the same bdd as the union of the members.
+	const bdd members = a1->make_bdd() | a2->make_bdd() | a3->make_bdd() | a4->make_bdd() | a5->make_bdd();
+	EXPECT_EQ(g2->make_bdd(), members);
+	EXPECT_EQ(g1->make_bdd(), a3->make_bdd() | a5->make_bdd());
+
+	std::unique_ptr<const DstAddress> a6{ DstAddress::create("a6", "10.0.3.0/28", IPAddressModel::IP4Model, true) };
+	EXPECT_EQ(g2->make_bdd() & a6->make_bdd(), a6->make_bdd());
+}
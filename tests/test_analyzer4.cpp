@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "model/address.h"
 #include "model/zone.h"
@@ -12,6 +17,11 @@
 #include "model/rule.h"
 #include "model/firewall.h"
 #include "model/analyzer.h"
+#include "model/domains.h"
+#include "model/anomalysink.h"
+#include "model/profiler.h"
+#include "model/ruleindex.h"
+#include "model/tablewriter.h"
 
 using namespace fwm;
 
@@ -71,21 +81,21 @@ TEST(Analyzer4, any) {
 	}
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "corporate_net", "any"),
-		*firewall)
+		create_predicate(network, "any", "corporate_net", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "any", "any"),
-		*firewall)
+		create_predicate(network, "any", "any", "any"))
 	);
 
 	{
@@ -126,21 +136,21 @@ TEST(Analyzer4, deny)
 	}
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "corporate_net", "any"),
-		*firewall)
+		create_predicate(network, "any", "corporate_net", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::DENY,
-		create_predicate(network, "any", "any", "any"),
-		*firewall)
+		create_predicate(network, "any", "any", "any"))
 	);
 
 	Analyzer analyzer(firewall->acl(), network.config().ip_model);
@@ -151,6 +161,63 @@ TEST(Analyzer4, deny)
 
 
 
+TEST(Analyzer4, deny_all)
+{
+	// Define network objects, "all" is another name of the any address.
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("corporate_net", "10.0.0.0/8");
+	network.register_dst_address("corporate_net", "10.0.0.0/8");
+	network.register_src_address("all", "0.0.0.0/0");
+	network.register_dst_address("all", "0.0.0.0/0");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	struct {
+		RuleAction action;
+		const char* src;
+		const char* dst;
+		bool negate_src;
+		bool deny_all;
+	} rules[] = {
+		{ RuleAction::ALLOW, "any", "any", false, false },
+		{ RuleAction::DENY, "corporate_net", "any", false, false },
+		{ RuleAction::DENY, "corporate_net", "any", true, false },
+		{ RuleAction::DENY, "all", "all", false, true },
+		{ RuleAction::DENY, "any", "any", false, true }
+	};
+
+	int id = 0;
+	for (const auto& rule : rules) {
+		id++;
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			rule.action,
+			create_predicate(network, rule.src, rule.dst, "any", rule.negate_src))
+		);
+	}
+
+	// A deny all rule is recognized from its bdd, the stored bdd gives the
+	// same answer as the bdd built from the predicate.
+	for (int pass = 0; pass < 2; pass++) {
+		id = 0;
+		for (const auto& rule : rules) {
+			const Rule* fw_rule = firewall->get_rule(++id);
+			ASSERT_NE(fw_rule, nullptr);
+			EXPECT_EQ(fw_rule->is_deny_all(), rule.deny_all);
+			EXPECT_EQ(fw_rule->is_deny_all(), fw_rule->action() == RuleAction::DENY && fw_rule->predicate().is_any());
+		}
+
+		firewall->clear_rule_bdds();
+	}
+}
+
+
 static bool interrupt_cb()
 {
 	return false;
@@ -179,21 +246,21 @@ TEST(Analyzer4, shadowing) {
 
 	// Add rules
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::DENY,
-		create_predicate(network, "R_10.1.1.0/25", "any", "any"),
-		*firewall)
+		create_predicate(network, "R_10.1.1.0/25", "any", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any"),
-		*firewall)
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any"))
 	);
 
 	{
@@ -209,3 +276,1034 @@ TEST(Analyzer4, shadowing) {
 		}
 	}
 }
+
+
+TEST(Analyzer4, bdd_store) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(
+		*firewall,
+		"rule1",
+		1,
+		RuleStatus::ENABLED,
+		RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "http"))
+	);
+
+	firewall->add_rule(new Rule(
+		*firewall,
+		"rule2",
+		2,
+		RuleStatus::ENABLED,
+		RuleAction::DENY,
+		create_predicate(network, "any", "any", "any"))
+	);
+
+	for (const Rule* rule : firewall->acl()) {
+		// The stored bdd is identical to the bdd built from the predicate.
+		EXPECT_TRUE(rule->predicate_bdd().make_bdd() == rule->predicate().make_bdd());
+
+		// The same node is returned until the rule is invalidated.
+		EXPECT_EQ(&rule->predicate_bdd(), &rule->predicate_bdd());
+	}
+
+	// Disabling a rule invalidates its bdd.
+	Rule* rule1 = firewall->get_rule(1);
+	rule1->set_rule_status(RuleStatus::DISABLED);
+	rule1->set_rule_status(RuleStatus::ENABLED);
+	EXPECT_TRUE(rule1->predicate_bdd().make_bdd() == rule1->predicate().make_bdd());
+
+	{
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+		RuleAnomalies anomalies = analyzer.check_anomaly(interrupt_cb);
+		EXPECT_EQ(anomalies.size(), 0);
+	}
+}
+
+
+static const Predicate* create_zone_predicate(fwm::Network& network,
+	std::string src_zone,
+	std::string dst_zone,
+	std::string src,
+	std::string dst,
+	std::string svc)
+{
+	SrcZoneGroupPtr sz = std::make_unique<SrcZoneGroup>("src-z", network.get_src_zone(src_zone));
+	SrcAddressGroupPtr sa = std::make_unique<SrcAddressGroup>("src-g", network.get_src_address(src));
+	DstZoneGroupPtr dz = std::make_unique<DstZoneGroup>("dst-z", network.get_dst_zone(dst_zone));
+	DstAddressGroupPtr da = std::make_unique<DstAddressGroup>("dst-g", network.get_dst_address(dst));
+	ServiceGroupPtr services = std::make_unique<ServiceGroup>("svc", network.get_service(svc));
+	ApplicationGroupPtr applications = std::make_unique<ApplicationGroup>("app", network.get_application("any"));
+	UserGroupPtr users = std::make_unique<UserGroup>("user", network.get_user("any"));
+	UrlGroupPtr urls = std::make_unique<UrlGroup>("url", network.get_url("any"));
+
+	return new Predicate(
+		Sources{ sz.release(), sa.release(), false },
+		Destinations{ dz.release(), da.release(), false },
+		services.release(),
+		applications.release(),
+		users.release(),
+		urls.release());
+}
+
+
+static void expect_same_anomalies(const RuleAnomalies& anomalies1, const RuleAnomalies& anomalies2)
+{
+	EXPECT_EQ(anomalies1.missing_deny_all, anomalies2.missing_deny_all);
+	ASSERT_EQ(anomalies1.size(), anomalies2.size());
+
+	auto it2 = anomalies2.begin();
+	for (const RuleAnomalyPtr& anomaly1 : anomalies1) {
+		const RuleAnomalyPtr& anomaly2 = *it2++;
+
+		EXPECT_EQ(anomaly1->rule().id(), anomaly2->rule().id());
+		EXPECT_EQ(anomaly1->details().anomaly_scope(), anomaly2->details().anomaly_scope());
+		EXPECT_EQ(anomaly1->details().anomaly_type(), anomaly2->details().anomaly_type());
+
+		const std::vector<RuleList> related1 = anomaly1->details().related_rules();
+		const std::vector<RuleList> related2 = anomaly2->details().related_rules();
+		ASSERT_EQ(related1.size(), related2.size());
+		for (size_t i = 0; i < related1.size(); i++)
+			EXPECT_EQ(related1[i].id_list(), related2[i].id_list());
+	}
+}
+
+
+TEST(Analyzer4, parallel) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_src_address("R_172.16.1.0/24", "172.16.1.0/24");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+	for (const char* zone : { "z1", "z2", "z3" }) {
+		network.register_src_zone(zone);
+		network.register_dst_zone(zone);
+	}
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	struct {
+		const char* src_zone;
+		const char* dst_zone;
+		RuleAction action;
+		const char* src;
+		const char* dst;
+		const char* svc;
+	} rules[] = {
+		{ "z1",  "z2",  RuleAction::DENY,  "R_10.1.1.0/25",   "any",              "any"  },
+		{ "z1",  "z2",  RuleAction::ALLOW, "R_10.1.1.0/25",   "R_192.168.1.0/24", "any"  },
+		{ "z2",  "z3",  RuleAction::ALLOW, "any",             "R_192.168.1.0/24", "any"  },
+		{ "z2",  "z3",  RuleAction::ALLOW, "R_10.1.1.0/25",   "R_192.168.1.0/24", "http" },
+		{ "z3",  "z1",  RuleAction::ALLOW, "R_172.16.1.0/24", "any",              "http" },
+		{ "any", "z3",  RuleAction::DENY,  "R_172.16.1.0/24", "any",              "any"  },
+		{ "z3",  "z1",  RuleAction::DENY,  "R_172.16.1.0/24", "any",              "http" },
+		{ "any", "any", RuleAction::DENY,  "any",             "any",              "any"  }
+	};
+
+	int id = 0;
+	for (const auto& rule : rules) {
+		id++;
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			rule.action,
+			create_zone_predicate(network, rule.src_zone, rule.dst_zone, rule.src, rule.dst, rule.svc))
+		);
+	}
+
+	{
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+
+		// the last deny all rule is excluded from the slices.
+		const std::vector<RuleList> slices = analyzer.partition();
+		ASSERT_EQ(slices.size(), 3);
+		EXPECT_EQ(slices[0].id_list(), std::vector<int>({ 1, 2 }));
+		EXPECT_EQ(slices[1].id_list(), std::vector<int>({ 3, 4, 6 }));
+		EXPECT_EQ(slices[2].id_list(), std::vector<int>({ 5, 7 }));
+
+		const RuleAnomalies serial = analyzer.check_anomaly(interrupt_cb);
+		const RuleAnomalies parallel = analyzer.check_anomaly(4, nullptr, interrupt_cb);
+		EXPECT_EQ(serial.size(), 4);
+		expect_same_anomalies(serial, parallel);
+
+		// The merged results fill the cache, the serial analysis reuses them.
+		AnomalyCache cache;
+		expect_same_anomalies(serial, analyzer.check_anomaly(4, &cache, interrupt_cb));
+		const std::vector<const Rule*> rules{ analyzer.acl().begin(), analyzer.acl().end() };
+		EXPECT_EQ(cache.prefix_size(rules), 7);
+		expect_same_anomalies(serial, analyzer.check_anomaly(cache, interrupt_cb));
+
+		// The merged results are written to the sink in the acl order.
+		std::ostringstream serial_output;
+		RuleAnomalyCsvSink serial_sink{ serial_output, true };
+		analyzer.check_anomaly(serial_sink, nullptr, interrupt_cb);
+
+		std::ostringstream parallel_output;
+		RuleAnomalyCsvSink parallel_sink{ parallel_output, true };
+		analyzer.check_anomaly(4, parallel_sink, nullptr, interrupt_cb);
+		EXPECT_EQ(parallel_sink.count(), serial.size());
+		EXPECT_EQ(parallel_sink.missing_deny_all, serial.missing_deny_all);
+		EXPECT_EQ(parallel_output.str(), serial_output.str());
+
+		// The counters of the workers are added to the profiler.
+		Profiler profiler;
+		analyzer.set_profiler(&profiler);
+		profiler.start();
+		analyzer.check_anomaly(4, nullptr, interrupt_cb);
+		profiler.stop();
+		analyzer.set_profiler(nullptr);
+
+		const Table phases = profiler.phases_table();
+		bool check_rule_found = false;
+		for (size_t row = 0; row < phases.row_count(); row++) {
+			if (phases.get_row(row).cell(0).line(0) == "check_rule") {
+				EXPECT_EQ(phases.get_row(row).cell(1).line(0), "7");
+				check_rule_found = true;
+			}
+		}
+		EXPECT_TRUE(check_rule_found);
+
+		// The peak node usage of the workers is merged in the summary.
+		const Table summary = profiler.summary_table();
+		bool peak_found = false;
+		for (size_t row = 0; row < summary.row_count(); row++) {
+			if (summary.get_row(row).cell(0).line(0) == "peak nodes in use by a worker") {
+				EXPECT_GT(std::stoi(summary.get_row(row).cell(1).line(0)), 0);
+				peak_found = true;
+			}
+		}
+		EXPECT_TRUE(peak_found);
+	}
+
+	// Without the deny all rule.
+	firewall->get_rule(8)->set_rule_status(RuleStatus::DISABLED);
+	{
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+		const RuleAnomalies serial = analyzer.check_anomaly(interrupt_cb);
+		const RuleAnomalies parallel = analyzer.check_anomaly(2, nullptr, interrupt_cb);
+		EXPECT_TRUE(serial.missing_deny_all);
+		expect_same_anomalies(serial, parallel);
+	}
+}
+
+
+TEST(Analyzer4, threads) {
+
+	// Builds a network and a firewall in the bdd manager of the current
+	// thread and checks the anomalies of the firewall.
+	auto check_anomaly = [](std::function<void(const RuleAnomalies&)> check_cb) -> void {
+		ModelConfig model_config;
+		Network network(model_config);
+		network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+		network.register_src_address("R_172.16.1.0/24", "172.16.1.0/24");
+		network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+		network.register_service("http", "tcp/80");
+		for (const char* zone : { "z1", "z2", "z3" }) {
+			network.register_src_zone(zone);
+			network.register_dst_zone(zone);
+		}
+
+		network.add(new Firewall("test", network));
+		Firewall *firewall = network.get("test");
+
+		struct {
+			const char* src_zone;
+			const char* dst_zone;
+			RuleAction action;
+			const char* src;
+			const char* dst;
+			const char* svc;
+		} rules[] = {
+			{ "z1",  "z2",  RuleAction::DENY,  "R_10.1.1.0/25",   "any",              "any"  },
+			{ "z1",  "z2",  RuleAction::ALLOW, "R_10.1.1.0/25",   "R_192.168.1.0/24", "any"  },
+			{ "z2",  "z3",  RuleAction::ALLOW, "any",             "R_192.168.1.0/24", "any"  },
+			{ "z2",  "z3",  RuleAction::ALLOW, "R_10.1.1.0/25",   "R_192.168.1.0/24", "http" },
+			{ "z3",  "z1",  RuleAction::ALLOW, "R_172.16.1.0/24", "any",              "http" },
+			{ "any", "z3",  RuleAction::DENY,  "R_172.16.1.0/24", "any",              "any"  },
+			{ "z3",  "z1",  RuleAction::DENY,  "R_172.16.1.0/24", "any",              "http" }
+		};
+
+		int id = 0;
+		for (const auto& rule : rules) {
+			id++;
+			firewall->add_rule(new Rule(
+				*firewall,
+				"rule" + std::to_string(id),
+				id,
+				RuleStatus::ENABLED,
+				rule.action,
+				create_zone_predicate(network, rule.src_zone, rule.dst_zone, rule.src, rule.dst, rule.svc))
+			);
+		}
+
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+		check_cb(analyzer.check_anomaly(interrupt_cb));
+	};
+
+	// Counts the variables of the support and the satisfying assignments of
+	// a set of ports.  The support and allsat operations keep their state in
+	// the bdd manager of the thread.
+	auto check_ports = []() -> std::pair<int, int> {
+		static thread_local int assignment_count;
+
+		const bvec& var = Domains::get().get_var(DomainType::DstTcpPort);
+		bdd ports{ bddfalse };
+		for (int port = 0; port < 2000; port += 7)
+			ports |= var == bvec_con(16, port);
+
+		int var_count = 0;
+		for (int round = 0; round < 50; round++) {
+			var_count = 0;
+			for (bdd support = bdd_support(ports); support != bddtrue; support = bdd_high(support))
+				var_count++;
+
+			assignment_count = 0;
+			bdd_allsat(ports, [](char*, int) -> void { assignment_count++; });
+		}
+
+		return { var_count, assignment_count };
+	};
+	const std::pair<int, int> expected_ports = check_ports();
+	ASSERT_EQ(expected_ports.first, 16);
+
+	// The anomalies found by the main thread.
+	std::vector<std::pair<int, RuleAnomalyType>> expected;
+	check_anomaly([&expected](const RuleAnomalies& anomalies) -> void {
+		for (const RuleAnomalyPtr& anomaly : anomalies)
+			expected.push_back({ anomaly->rule().id(), anomaly->details().anomaly_type() });
+	});
+	ASSERT_EQ(expected.size(), 4);
+
+	// Each thread has its own bdd manager, the analyses run concurrently and
+	// find the same anomalies.
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < 4; thread++) {
+		threads.push_back(std::thread([&check_anomaly, &expected, &check_ports, &expected_ports]() -> void {
+			Domains::get().init_bdd(100000, 10000);
+			EXPECT_EQ(check_ports(), expected_ports);
+
+			check_anomaly([&expected](const RuleAnomalies& anomalies) -> void {
+				ASSERT_EQ(anomalies.size(), expected.size());
+
+				size_t index = 0;
+				for (const RuleAnomalyPtr& anomaly : anomalies) {
+					EXPECT_EQ(anomaly->rule().id(), expected[index].first);
+					EXPECT_EQ(anomaly->details().anomaly_type(), expected[index].second);
+					index++;
+				}
+			});
+			EXPECT_EQ(check_ports(), expected_ports);
+
+			Domains::get().reset_bdd();
+		}));
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// The bdd manager of the main thread is unchanged.
+	check_anomaly([&expected](const RuleAnomalies& anomalies) -> void {
+		EXPECT_EQ(anomalies.size(), expected.size());
+	});
+}
+
+
+TEST(Analyzer4, incremental) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_src_address("R_10.1.1.0/24", "10.1.1.0/24");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	struct {
+		RuleAction action;
+		const char* src;
+		const char* dst;
+		const char* svc;
+	} rules[] = {
+		{ RuleAction::DENY,  "R_10.1.1.0/25", "R_192.168.1.0/24", "http" },
+		{ RuleAction::ALLOW, "R_10.1.1.0/25", "R_192.168.1.0/24", "http" },
+		{ RuleAction::ALLOW, "R_10.1.1.0/24", "R_192.168.1.0/24", "any"  },
+		{ RuleAction::ALLOW, "R_10.1.1.0/25", "any",              "http" },
+		{ RuleAction::DENY,  "R_10.1.1.0/24", "any",              "any"  },
+		{ RuleAction::ALLOW, "R_10.1.1.0/25", "R_192.168.1.0/24", "any"  },
+		{ RuleAction::DENY,  "any",           "any",              "any"  }
+	};
+
+	int id = 0;
+	for (const auto& rule : rules) {
+		id++;
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			rule.action,
+			create_predicate(network, rule.src, rule.dst, rule.svc))
+		);
+	}
+
+	AnomalyCache cache{ 2 };
+
+	auto check = [&]() {
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+		const RuleAnomalies expected = analyzer.check_anomaly(interrupt_cb);
+		const RuleAnomalies anomalies = analyzer.check_anomaly(cache, interrupt_cb);
+		expect_same_anomalies(expected, anomalies);
+	};
+
+	check();
+	check();
+
+	// Disable and enable rules, the analysis restarts from a checkpoint.
+	for (const int rule_id : { 6, 2, 4, 7, 1 }) {
+		firewall->get_rule(rule_id)->set_rule_status(RuleStatus::DISABLED);
+		check();
+	}
+
+	for (const int rule_id : { 7, 4, 1, 6, 2 }) {
+		firewall->get_rule(rule_id)->set_rule_status(RuleStatus::ENABLED);
+		check();
+	}
+}
+
+
+TEST(Analyzer4, rule_index) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_src_address("R_10.1.1.128/25", "10.1.1.128/25");
+	network.register_src_address("R_172.16.1.0/24", "172.16.1.0/24");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_dst_address("R_192.168.2.0/24", "192.168.2.0/24");
+	network.register_service("http", "tcp/80");
+	network.register_service("https", "tcp/443");
+	network.register_service("dns", "udp/53");
+	network.register_service("ping", "icmp/8");
+	for (const char* zone : { "z1", "z2", "z3" }) {
+		network.register_src_zone(zone);
+		network.register_dst_zone(zone);
+	}
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	const char* zones[] = { "any", "z1", "z2", "z3" };
+	const char* src_addresses[] = { "any", "R_10.1.1.0/25", "R_10.1.1.128/25", "R_172.16.1.0/24" };
+	const char* dst_addresses[] = { "any", "R_192.168.1.0/24", "R_192.168.2.0/24" };
+	const char* services[] = { "any", "http", "https", "dns", "ping" };
+
+	// Generate rules using a simple deterministic sequence.
+	unsigned int seed = 17;
+	auto next = [&seed](unsigned int n) -> unsigned int {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) % n;
+	};
+
+	for (int id = 1; id <= 60; id++) {
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			next(2) ? RuleAction::ALLOW : RuleAction::DENY,
+			create_zone_predicate(
+				network,
+				zones[next(4)],
+				zones[next(4)],
+				src_addresses[next(4)],
+				dst_addresses[next(3)],
+				services[next(5)]))
+		);
+	}
+
+	const RuleList acl = firewall->acl();
+	const RuleIndex index(acl);
+
+	// All overlapping rules must be selected by the index.
+	size_t pruned = 0;
+	for (const Rule* rule : acl) {
+		const RuleList candidates = index.candidates(*rule, false);
+		const std::vector<int> candidate_ids = candidates.id_list();
+
+		const RuleList overlapping = acl.filter_before(rule, [rule](const Rule& other) -> bool {
+			return rule->predicate_bdd().overlaps(other.predicate_bdd());
+		});
+
+		for (const int id : overlapping.id_list())
+			EXPECT_NE(std::find(candidate_ids.begin(), candidate_ids.end(), id), candidate_ids.end());
+
+		pruned += acl.filter_before(rule, [](const Rule&) { return true; }).size() - candidates.size();
+	}
+
+	// The index removes some rules.
+	EXPECT_GT(pruned, 0);
+}
+
+
+TEST(Analyzer4, symmetry) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	for (const char* address : { "10.1.1.0/24", "192.168.1.0/24" }) {
+		network.register_src_address(std::string("R_") + address, address);
+		network.register_dst_address(std::string("R_") + address, address);
+	}
+	network.register_service("http", "tcp/80");
+	for (const char* zone : { "z1", "z2" }) {
+		network.register_src_zone(zone);
+		network.register_dst_zone(zone);
+	}
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	const char* zones[] = { "any", "z1", "z2" };
+	const char* addresses[] = { "any", "R_10.1.1.0/24", "R_192.168.1.0/24" };
+	const char* services[] = { "any", "http" };
+
+	// Generate rules using a simple deterministic sequence.
+	unsigned int seed = 5;
+	auto next = [&seed](unsigned int n) -> unsigned int {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) % n;
+	};
+
+	for (int id = 1; id <= 40; id++) {
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			next(2) ? RuleAction::ALLOW : RuleAction::DENY,
+			create_zone_predicate(
+				network,
+				zones[next(3)],
+				zones[next(3)],
+				addresses[next(3)],
+				addresses[next(3)],
+				services[next(2)]))
+		);
+	}
+
+	// Compare with the symmetrical predicates built from the model.
+	const RuleList acl = firewall->acl();
+	std::vector<std::pair<int, int>> expected;
+	for (const Rule* rule : acl) {
+		const RuleList others = acl.filter([rule](const Rule& other) { return rule->id() < other.id(); });
+		for (const Rule* other : others) {
+			const PredicatePtr symmetrical{ other->predicate().symmetrical() };
+			if (rule->action() == other->action() && rule->predicate().equal(*symmetrical))
+				expected.push_back(std::make_pair(rule->id(), other->id()));
+		}
+	}
+
+	Analyzer analyzer(acl, network.config().ip_model);
+	std::vector<std::pair<int, int>> found;
+	for (const RulePair& pair : analyzer.check_symmetry(true, interrupt_cb))
+		found.push_back(std::make_pair(std::get<0>(pair)->id(), std::get<1>(pair)->id()));
+
+	EXPECT_GT(expected.size(), 0);
+	EXPECT_EQ(found, expected);
+}
+
+
+TEST(Analyzer4, duplicate) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/24", "10.1.1.0/24");
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_src_address("R_10.1.1.128/25", "10.1.1.128/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+	for (const char* zone : { "z1", "z2" }) {
+		network.register_src_zone(zone);
+		network.register_dst_zone(zone);
+	}
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(*firewall, "rule1", 1, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_zone_predicate(network, "z1", "z2", "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule2", 2, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_zone_predicate(network, "z2", "z2", "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule3", 3, RuleStatus::ENABLED, RuleAction::DENY,
+		create_zone_predicate(network, "z1", "z2", "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+
+	// Same predicate as rule 1 built from two addresses
+	SrcAddressGroup* sa = new SrcAddressGroup("src-g", network.get_src_address("R_10.1.1.0/25"));
+	sa->add_member(network.get_src_address("R_10.1.1.128/25"));
+	firewall->add_rule(new Rule(*firewall, "rule4", 4, RuleStatus::ENABLED, RuleAction::ALLOW,
+		new Predicate(
+			Sources{ new SrcZoneGroup("src-z", network.get_src_zone("z1")), sa, false },
+			Destinations{
+				new DstZoneGroup("dst-z", network.get_dst_zone("z2")),
+				new DstAddressGroup("dst-g", network.get_dst_address("R_192.168.1.0/24")),
+				false },
+			new ServiceGroup("svc", network.get_service("http")),
+			new ApplicationGroup("app", network.get_application("any")),
+			new UserGroup("user", network.get_user("any")),
+			new UrlGroup("url", network.get_url("any")))));
+
+	firewall->add_rule(new Rule(*firewall, "rule5", 5, RuleStatus::DISABLED, RuleAction::ALLOW,
+		create_zone_predicate(network, "z1", "z2", "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule6", 6, RuleStatus::ENABLED, RuleAction::DENY,
+		create_zone_predicate(network, "z2", "z1", "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+
+	{
+		// Rule 1 and rule 4 are identical, rule 5 is disabled.
+		const std::list<RuleList> groups = analyzer.check_duplicate(interrupt_cb);
+		ASSERT_EQ(groups.size(), 1);
+		EXPECT_EQ(groups.front().id_list(), std::vector<int>({ 1, 4 }));
+	}
+
+	{
+		// Ignore the source zone.
+		const Predicate::BddOptions options({
+			Predicate::BddOption::DestinationZone,
+			Predicate::BddOption::Application,
+			Predicate::BddOption::User,
+			Predicate::BddOption::Url
+		});
+
+		const std::list<RuleList> groups = analyzer.check_duplicate(options, interrupt_cb);
+		ASSERT_EQ(groups.size(), 1);
+		EXPECT_EQ(groups.front().id_list(), std::vector<int>({ 1, 2, 4 }));
+	}
+
+	{
+		// Ignore both zones.
+		const Predicate::BddOptions options({ Predicate::BddOption::Application });
+
+		const std::list<RuleList> groups = analyzer.check_duplicate(options, interrupt_cb);
+		ASSERT_EQ(groups.size(), 2);
+		EXPECT_EQ(groups.front().id_list(), std::vector<int>({ 1, 2, 4 }));
+		EXPECT_EQ(groups.back().id_list(), std::vector<int>({ 3, 6 }));
+	}
+}
+
+
+TEST(Analyzer4, profile) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(*firewall, "rule1", 1, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/25", "any", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule2", 2, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any")));
+
+	Profiler profiler;
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+	analyzer.set_profiler(&profiler);
+
+	profiler.start();
+	RuleAnomalies anomalies = analyzer.check_anomaly(interrupt_cb);
+	profiler.stop();
+
+	// The profiler does not change the result.
+	ASSERT_EQ(anomalies.size(), 1);
+	EXPECT_EQ(anomalies.front()->details().anomaly_type(), RuleAnomalyType::Shadowing);
+
+	// The shadowed rule is explained by find_overlaping.
+	const Table phases = profiler.phases_table();
+	std::vector<std::string> names;
+	for (size_t row = 0; row < phases.row_count(); row++)
+		names.push_back(phases.get_row(row).cell(0).line(0));
+
+	for (const char* name : { "make_bdd", "State::update", "check_rule", "find_overlaping" })
+		EXPECT_NE(std::find(names.begin(), names.end(), name), names.end());
+}
+
+
+TEST(Analyzer4, sink) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(*firewall, "rule1", 1, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/25", "any", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule2", 2, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule3", 3, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any")));
+
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+	const RuleAnomalies anomalies = analyzer.check_anomaly(interrupt_cb);
+	ASSERT_EQ(anomalies.size(), 2);
+
+	// The csv sink writes the same content as the anomalies table.
+	std::ostringstream table_output;
+	const Table table = anomalies.output_anomalies(true);
+	TableCsvWriter writer{ table };
+	writer.newline('\n').separator(',').write(table_output, interrupt_cb);
+
+	std::ostringstream csv_output;
+	RuleAnomalyCsvSink csv_sink{ csv_output, true };
+	analyzer.check_anomaly(csv_sink, nullptr, interrupt_cb);
+	EXPECT_EQ(csv_sink.count(), 2);
+	EXPECT_TRUE(csv_sink.missing_deny_all);
+	EXPECT_EQ(csv_output.str(), table_output.str());
+
+	// The json sink writes a line per anomaly, the cache is filled.
+	AnomalyCache cache;
+	std::ostringstream json_output;
+	RuleAnomalyJsonSink json_sink{ json_output, false };
+	analyzer.check_anomaly(json_sink, &cache, interrupt_cb);
+	EXPECT_EQ(json_sink.count(), 2);
+	const std::string json_lines = json_output.str();
+	EXPECT_EQ(json_lines.find("{\"id\": 2, \"src.zone\": \"any\""), 0);
+	EXPECT_EQ(std::count(json_lines.begin(), json_lines.end(), '\n'), 2);
+	EXPECT_NE(std::unique_ptr<RuleAnomaly>(cache.result(1)), nullptr);
+}
+
+
+TEST(Analyzer4, minimal_explanation) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/24", "10.1.1.0/24");
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_src_address("R_10.1.1.128/25", "10.1.1.128/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(*firewall, "rule1", 1, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/25", "any", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule2", 2, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.128/25", "any", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule3", 3, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule4", 4, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/24", "R_192.168.1.0/24", "any")));
+	firewall->add_rule(new Rule(*firewall, "rule5", 5, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "http")));
+
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+
+	// Returns the rules explaining the anomaly of each rule.
+	auto explanations = [](const RuleAnomalies& anomalies) -> std::vector<std::vector<int>> {
+		std::vector<std::vector<int>> rules;
+		for (const RuleAnomalyPtr& anomaly : anomalies)
+			rules.push_back(anomaly->details().related_rules()[0].id_list());
+		return rules;
+	};
+
+	// All overlapping rules are reported.  Rule 3 is redundant, rules 4 and
+	// 5 are shadowed.
+	const RuleAnomalies all_rules = analyzer.check_anomaly(interrupt_cb);
+	ASSERT_EQ(all_rules.size(), 3);
+	EXPECT_EQ(explanations(all_rules), std::vector<std::vector<int>>({ { 1, 2 }, { 1, 2, 3 }, { 1, 3 } }));
+
+	// Rule 3 is not required to cover rule 4, rule 3 alone covers rule 5.
+	analyzer.set_explanation(RuleAnomalyExplanation::MinimalRules);
+	const RuleAnomalies minimal_rules = analyzer.check_anomaly(interrupt_cb);
+	ASSERT_EQ(minimal_rules.size(), 3);
+	EXPECT_EQ(explanations(minimal_rules), std::vector<std::vector<int>>({ { 1, 2 }, { 1, 2 }, { 3 } }));
+
+	// The cached results are discarded when the explanation mode changes.
+	AnomalyCache cache;
+	analyzer.check_anomaly(cache, interrupt_cb);
+	analyzer.set_explanation(RuleAnomalyExplanation::AllRules);
+	const RuleAnomalies cached_rules = analyzer.check_anomaly(cache, interrupt_cb);
+	EXPECT_EQ(explanations(cached_rules), explanations(all_rules));
+}
+
+
+TEST(Analyzer4, fast_classification) {
+
+	// Define network objects
+	ModelConfig model_config;
+	Network network(model_config);
+	network.register_src_address("R_10.1.1.0/24", "10.1.1.0/24");
+	network.register_src_address("R_10.1.1.0/25", "10.1.1.0/25");
+	network.register_dst_address("R_192.168.1.0/24", "192.168.1.0/24");
+	network.register_service("http", "tcp/80");
+	network.register_service("https", "tcp/443");
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	firewall->add_rule(new Rule(*firewall, "rule1", 1, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "R_10.1.1.0/25", "any", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule2", 2, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/24", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule3", 3, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "http")));
+	firewall->add_rule(new Rule(*firewall, "rule4", 4, RuleStatus::ENABLED, RuleAction::ALLOW,
+		create_predicate(network, "R_10.1.1.0/24", "any", "https")));
+	firewall->add_rule(new Rule(*firewall, "rule5", 5, RuleStatus::ENABLED, RuleAction::DENY,
+		create_predicate(network, "any", "any", "any")));
+
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+
+	// Returns the anomaly type of each rule.
+	auto anomaly_types = [](const RuleAnomalies& anomalies) -> std::vector<std::pair<int, RuleAnomalyType>> {
+		std::vector<std::pair<int, RuleAnomalyType>> types;
+		for (const RuleAnomalyPtr& anomaly : anomalies)
+			types.push_back({ anomaly->rule().id(), anomaly->details().anomaly_type() });
+		return types;
+	};
+
+	// Rule 2 is correlated with rule 1, rule 3 is shadowed by rule 1.
+	const RuleAnomalies all_rules = analyzer.check_anomaly(interrupt_cb);
+	ASSERT_EQ(all_rules.size(), 2);
+
+	// The fast mode classifies the rules the same way without reporting the
+	// related rules.
+	analyzer.set_explanation(RuleAnomalyExplanation::NoRules);
+	AnomalyCache cache;
+	const RuleAnomalies fast_rules = analyzer.check_anomaly(cache, interrupt_cb);
+	EXPECT_EQ(anomaly_types(fast_rules), anomaly_types(all_rules));
+	for (const RuleAnomalyPtr& anomaly : fast_rules)
+		EXPECT_FALSE(anomaly->details().is_explained());
+
+	// The anomaly of a single rule is explained on demand.
+	analyzer.set_explanation(RuleAnomalyExplanation::AllRules);
+	for (const RuleAnomalyPtr& expected : all_rules) {
+		const RuleAnomalyPtr anomaly = analyzer.check_anomaly(expected->rule(), &cache, interrupt_cb);
+		ASSERT_TRUE(anomaly);
+		EXPECT_EQ(anomaly->details().anomaly_type(), expected->details().anomaly_type());
+		EXPECT_EQ(anomaly->details().related_rules()[0].id_list(), expected->details().related_rules()[0].id_list());
+	}
+
+	// The last deny all rule is not analyzed.
+	EXPECT_FALSE(analyzer.check_anomaly(*firewall->get_rule(5), nullptr, interrupt_cb));
+}
+
+
+TEST(Analyzer4, fast_classification_scaling) {
+
+	// Returns the number of lookups in the operator caches done by the analysis
+	// of a firewall with n deny rules on distinct ports followed by n allow
+	// rules on port ranges.  Every allow rule generalizes all deny rules.
+	auto analysis_lookups = [](int n, RuleAnomalyExplanation explanation) -> size_t {
+		ModelConfig model_config;
+		Network network(model_config);
+
+		network.add(new Firewall("test", network));
+		Firewall *firewall = network.get("test");
+
+		for (int id = 1; id <= 2 * n; id++) {
+			const bool deny = id <= n;
+			const std::string service = deny ? "tcp/" + std::to_string(id) : "tcp/1-" + std::to_string(id);
+			network.register_service(service, service);
+
+			firewall->add_rule(new Rule(*firewall, "rule" + std::to_string(id), id, RuleStatus::ENABLED,
+				deny ? RuleAction::DENY : RuleAction::ALLOW,
+				create_predicate(network, "any", "any", service)));
+		}
+
+		Analyzer analyzer(firewall->acl(), network.config().ip_model);
+		analyzer.set_explanation(explanation);
+
+		bddCacheStat start_stats;
+		bdd_cachestats(&start_stats);
+		AnomalyCache cache;
+		const RuleAnomalies anomalies = analyzer.check_anomaly(cache, interrupt_cb);
+		bddCacheStat stop_stats;
+		bdd_cachestats(&stop_stats);
+
+		EXPECT_EQ(anomalies.size(), static_cast<size_t>(n));
+		for (const RuleAnomalyPtr& anomaly : anomalies)
+			EXPECT_EQ(anomaly->details().anomaly_type(), RuleAnomalyType::Generalization);
+
+		return (stop_stats.opHit + stop_stats.opMiss) - (start_stats.opHit + start_stats.opMiss);
+	};
+
+	// The fast mode stops at the first deny rule that is a subset of an allow
+	// rule, the bdd operations grow linearly with the number of rules.  The
+	// full analysis reports all deny rules and grows quadratically.
+	const size_t fast_small = analysis_lookups(300, RuleAnomalyExplanation::NoRules);
+	const size_t fast_large = analysis_lookups(1200, RuleAnomalyExplanation::NoRules);
+	const size_t full_small = analysis_lookups(300, RuleAnomalyExplanation::AllRules);
+	const size_t full_large = analysis_lookups(1200, RuleAnomalyExplanation::AllRules);
+
+	EXPECT_LT(fast_large, 6 * fast_small);
+	EXPECT_GT(full_large, 10 * full_small);
+}
+
+
+TEST(Analyzer4, variable_orders) {
+
+	// Analyzes a firewall in a bdd manager initialized with a variable order
+	// and a reordering method, the variables are reordered between the
+	// analyses.  Returns a text listing the anomalies, the symmetrical rules
+	// and the duplicate rules.
+	auto analyze = [](VariableOrder order, ReorderMethod method) -> std::string {
+		std::ostringstream output;
+
+		std::thread thread([&output, order, method]() -> void {
+			Domains& domains = Domains::get();
+			domains.init_bdd(100000, 10000, order, method);
+			{
+				ModelConfig model_config;
+				Network network(model_config);
+				for (const char* address : { "10.1.1.0/24", "10.1.1.0/25", "192.168.1.0/24" }) {
+					network.register_src_address(std::string("R_") + address, address);
+					network.register_dst_address(std::string("R_") + address, address);
+				}
+				network.register_service("http", "tcp/80");
+				for (const char* zone : { "z1", "z2" }) {
+					network.register_src_zone(zone);
+					network.register_dst_zone(zone);
+				}
+
+				network.add(new Firewall("test", network));
+				Firewall *firewall = network.get("test");
+
+				const char* zones[] = { "any", "z1", "z2" };
+				const char* addresses[] = { "any", "R_10.1.1.0/24", "R_10.1.1.0/25", "R_192.168.1.0/24" };
+				const char* services[] = { "any", "http" };
+
+				unsigned int seed = 11;
+				auto next = [&seed](unsigned int n) -> unsigned int {
+					seed = seed * 1103515245 + 12345;
+					return (seed >> 16) % n;
+				};
+
+				for (int id = 1; id <= 60; id++) {
+					firewall->add_rule(new Rule(
+						*firewall,
+						"rule" + std::to_string(id),
+						id,
+						RuleStatus::ENABLED,
+						next(2) ? RuleAction::ALLOW : RuleAction::DENY,
+						create_zone_predicate(
+							network,
+							zones[next(3)],
+							zones[next(3)],
+							addresses[next(4)],
+							addresses[next(4)],
+							services[next(2)]))
+					);
+				}
+
+				const RuleList acl = firewall->acl();
+				auto reorder = [method]() -> void {
+					switch (method) {
+					case ReorderMethod::Sift: bdd_reorder(BDD_REORDER_SIFT); break;
+					case ReorderMethod::Win2: bdd_reorder(BDD_REORDER_WIN2); break;
+					case ReorderMethod::Win3: bdd_reorder(BDD_REORDER_WIN3); break;
+					default: break;
+					}
+				};
+
+				Analyzer analyzer(acl, network.config().ip_model);
+				const RuleAnomalies anomalies = analyzer.check_anomaly(interrupt_cb);
+				for (const RuleAnomalyPtr& anomaly : anomalies) {
+					output << "anomaly " << anomaly->rule().id() << " " << static_cast<int>(anomaly->details().anomaly_type());
+					for (const RuleList& related : anomaly->details().related_rules()) {
+						output << " :";
+						for (const int id : related.id_list())
+							output << " " << id;
+					}
+					output << "\n";
+				}
+				reorder();
+
+				// The symmetrical rules found by swapping the variables are the
+				// rules whose predicates are symmetrical in the model.
+				std::vector<std::pair<int, int>> expected;
+				for (const Rule* rule : acl) {
+					const RuleList others = acl.filter([rule](const Rule& other) { return rule->id() < other.id(); });
+					for (const Rule* other : others) {
+						const PredicatePtr symmetrical{ other->predicate().symmetrical() };
+						if (rule->action() == other->action() && rule->predicate().equal(*symmetrical))
+							expected.push_back(std::make_pair(rule->id(), other->id()));
+					}
+				}
+
+				std::vector<std::pair<int, int>> found;
+				for (const RulePair& pair : analyzer.check_symmetry(true, interrupt_cb)) {
+					found.push_back(std::make_pair(std::get<0>(pair)->id(), std::get<1>(pair)->id()));
+					output << "symmetry " << found.back().first << " " << found.back().second << "\n";
+				}
+				EXPECT_GT(expected.size(), 0);
+				EXPECT_EQ(found, expected);
+				reorder();
+
+				for (const RuleList& duplicates : analyzer.check_duplicate(interrupt_cb)) {
+					output << "duplicate";
+					for (const int id : duplicates.id_list())
+						output << " " << id;
+					output << "\n";
+				}
+
+				// The anomalies don't depend on the order of the variables.
+				firewall->clear_rule_bdds();
+				Analyzer other_analyzer(acl, network.config().ip_model);
+				EXPECT_EQ(other_analyzer.check_anomaly(interrupt_cb).size(), anomalies.size());
+			}
+			domains.reset_bdd();
+		});
+		thread.join();
+
+		return output.str();
+	};
+
+	const std::string expected = analyze(VariableOrder::Domain, ReorderMethod::None);
+	EXPECT_NE(expected.find("anomaly"), std::string::npos);
+	EXPECT_NE(expected.find("duplicate"), std::string::npos);
+
+	for (const VariableOrder order : { VariableOrder::Domain, VariableOrder::Interleaved, VariableOrder::ZonesFirst }) {
+		for (const ReorderMethod method : { ReorderMethod::None, ReorderMethod::Sift, ReorderMethod::Win2, ReorderMethod::Win3 }) {
+			EXPECT_EQ(analyze(order, method), expected) << to_string(order) << " " << to_string(method);
+		}
+	}
+}
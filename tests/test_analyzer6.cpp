@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "model/address.h"
 #include "model/zone.h"
@@ -74,21 +77,21 @@ TEST(Analyzer6, any) {
 	}
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "corporate_net", "any"),
-		*firewall)
+		create_predicate(network, "any", "corporate_net", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "any", "any"),
-		*firewall)
+		create_predicate(network, "any", "any", "any"))
 	);
 
 	{
@@ -131,21 +134,21 @@ TEST(Analyzer6, deny)
 	}
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "any", "corporate_net", "any"),
-		*firewall)
+		create_predicate(network, "any", "corporate_net", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::DENY,
-		create_predicate(network, "any", "any", "any"),
-		*firewall)
+		create_predicate(network, "any", "any", "any"))
 	);
 
 	Analyzer analyzer(firewall->acl(), network.config().ip_model);
@@ -186,21 +189,21 @@ TEST(Analyzer6, shadowing) {
 
 	// Add rules
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule1",
 		1,
 		RuleStatus::ENABLED,
 		RuleAction::DENY,
-		create_predicate(network, "R_10.1.1.0/25", "any", "any"),
-		*firewall)
+		create_predicate(network, "R_10.1.1.0/25", "any", "any"))
 	);
 
 	firewall->add_rule(new Rule(
+		*firewall,
 		"rule2",
 		2,
 		RuleStatus::ENABLED,
 		RuleAction::ALLOW,
-		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any"),
-		*firewall)
+		create_predicate(network, "R_10.1.1.0/25", "R_192.168.1.0/24", "any"))
 	);
 
 	{
@@ -216,3 +219,65 @@ TEST(Analyzer6, shadowing) {
 		}
 	}
 }
+
+
+TEST(Analyzer6, symmetry) {
+	// Define network objects
+	ModelConfig model_config;
+	model_config.ip_model = IPAddressModel::IP6Model;
+	Network network(model_config);
+
+	// Ranges are decomposed into many prefixes, the address bdds are large.
+	const int address_count = 10;
+	for (int index = 0; index < address_count; index++) {
+		const std::string range = "2001:db8:" + std::to_string(index + 1) + "::3-2001:db8:" + std::to_string(index + 1) + ":7ff::1d";
+		network.register_src_address("R" + std::to_string(index), range);
+		network.register_dst_address("R" + std::to_string(index), range);
+	}
+
+	// Configure the test firewall
+	network.add(new Firewall("test", network));
+	Firewall *firewall = network.get("test");
+
+	// A rule for each pair of addresses followed by the symmetrical rules.
+	std::vector<std::pair<int, int>> address_pairs;
+	for (int src = 0; src < address_count; src++) {
+		for (int dst = src + 1; dst < address_count; dst++)
+			address_pairs.push_back(std::make_pair(src, dst));
+	}
+
+	const int pair_count = static_cast<int>(address_pairs.size());
+	for (int id = 1; id <= 2 * pair_count; id++) {
+		const auto& address_pair = address_pairs[(id - 1) % pair_count];
+		const bool swapped = id > pair_count;
+
+		firewall->add_rule(new Rule(
+			*firewall,
+			"rule" + std::to_string(id),
+			id,
+			RuleStatus::ENABLED,
+			RuleAction::ALLOW,
+			create_predicate(
+				network,
+				"R" + std::to_string(swapped ? address_pair.second : address_pair.first),
+				"R" + std::to_string(swapped ? address_pair.first : address_pair.second),
+				"any"))
+		);
+	}
+
+	std::vector<std::pair<int, int>> expected;
+	for (int id = 1; id <= pair_count; id++)
+		expected.push_back(std::make_pair(id, id + pair_count));
+
+	// Only the zone and address bdds of the rules are swapped, the search
+	// takes about the time needed to build the rule bdds.
+	Analyzer analyzer(firewall->acl(), network.config().ip_model);
+	const auto start_time = std::chrono::steady_clock::now();
+	std::vector<std::pair<int, int>> found;
+	for (const RulePair& pair : analyzer.check_symmetry(true, interrupt_cb))
+		found.push_back(std::make_pair(std::get<0>(pair)->id(), std::get<1>(pair)->id()));
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+	EXPECT_EQ(found, expected);
+	EXPECT_LT(elapsed.count(), 5.0);
+}
@@ -1,12 +1,18 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <buddy/bdd.h>
 #include "model/domains.h"
+#include "model/mvalue.h"
+#include "model/zone.h"
 
 TEST(Domains, size) {
 	using namespace fwm;
 
-	ASSERT_EQ(ZoneDomain::nbits(), 8);
+	ASSERT_EQ(ZoneDomain::nbits(), 16);
 	ASSERT_EQ(ZoneDomain::min(), 0);
-	ASSERT_EQ(ZoneDomain::max(), 255);
+	ASSERT_EQ(ZoneDomain::max(), UINT16_MAX);
 
 	ASSERT_EQ(SrcAddress4Domain::nbits(), 32);
 	ASSERT_EQ(SrcAddress4Domain::min(), 0);
@@ -35,3 +41,255 @@ TEST(Domains, size) {
 	ASSERT_EQ(DstUdpPortDomain::max(), UINT16_MAX);
 
 }
+
+
+TEST(Domains, reserve) {
+	using namespace fwm;
+
+	// Returns the first and the last level of the variable of a domain.
+	auto levels = [](DomainType dt) -> std::pair<int, int> {
+		const bvec& var = Domains::get().get_var(dt);
+		std::pair<int, int> range{ bdd_varnum(), -1 };
+		for (int bit = 0; bit < var.bitnum(); bit++) {
+			const int level = bdd_var2level(bdd_var(var[bit]));
+			range.first = std::min(range.first, level);
+			range.second = std::max(range.second, level);
+		}
+		return range;
+	};
+
+	// The test uses its own bdd manager, the variables are allocated by the
+	// first bdd built by the test.
+	std::thread thread([&levels]() -> void {
+		Domains& domains = Domains::get();
+		domains.init_bdd(100000, 10000, VariableOrder::ZonesFirst);
+
+		// The fixed size domains can't be extended.
+		EXPECT_EQ(domains.nbits(DomainType::Protocol), ProtocolDomain::nbits());
+		EXPECT_THROW(domains.reserve(DomainType::Protocol, 1), std::runtime_error);
+
+		// The variables are not extended before their allocation.
+		EXPECT_FALSE(domains.reserve(DomainType::SrcZone, 2));
+		EXPECT_FALSE(domains.reserve(DomainType::Url, 3));
+		EXPECT_EQ(domains.get_var(DomainType::Url).bitnum(), 2);
+		const bdd port = domains.get_var(DomainType::DstTcpPort) == bvec_con(16, 443);
+
+		// The variable of a domain is extended when a larger id is reserved.
+		const unsigned int epoch = domains.epoch();
+		EXPECT_FALSE(domains.reserve(DomainType::Url, 1));
+		EXPECT_TRUE(domains.reserve(DomainType::Url, 4));
+		EXPECT_NE(domains.epoch(), epoch);
+		EXPECT_EQ(domains.nbits(DomainType::Url), 3);
+		EXPECT_EQ(domains.get_var(DomainType::Url).bitnum(), 3);
+		EXPECT_THROW(domains.reserve(DomainType::Url, 1 << UrlDomain::nbits()), std::runtime_error);
+
+		// The new bits are inserted in the block of the domain and the order
+		// of the domains is kept.  The bdds built before keep their meaning.
+		EXPECT_EQ(levels(DomainType::Url).second - levels(DomainType::Url).first, 2);
+		EXPECT_LT(levels(DomainType::Url).second, levels(DomainType::SrcAddress4).first);
+		EXPECT_EQ(domains.get_var(DomainType::DstTcpPort) == bvec_con(16, 443), port);
+
+		// The source and destination zones have always the same size.
+		const uint32_t zone_id = 1 << domains.nbits(DomainType::DstZone);
+		EXPECT_TRUE(domains.reserve(DomainType::SrcZone, zone_id));
+		EXPECT_EQ(domains.nbits(DomainType::SrcZone), domains.nbits(DomainType::DstZone));
+		EXPECT_EQ(levels(DomainType::SrcZone).second + 1, levels(DomainType::DstZone).first);
+		EXPECT_LT(levels(DomainType::DstZone).second, levels(DomainType::Protocol).first);
+
+		std::unique_ptr<SrcZone> z1{ SrcZone::create("z1", zone_id) };
+		std::unique_ptr<SrcZone> z2{ SrcZone::create("z2", 1) };
+		std::unique_ptr<DstZone> z3{ DstZone::create("z3", zone_id) };
+		EXPECT_EQ(z1->make_bdd() & z2->make_bdd(), bddfalse);
+		EXPECT_EQ(domains.swap_src_dst(z1->make_bdd()), z3->make_bdd());
+		EXPECT_EQ(domains.get_var(DomainType::DstTcpPort) == bvec_con(16, 443), port);
+
+		// The extended variables are reordered as a whole.
+		bdd_reorder(BDD_REORDER_SIFT);
+		EXPECT_EQ(levels(DomainType::Url).second - levels(DomainType::Url).first, 2);
+		EXPECT_EQ(levels(DomainType::SrcZone).second - levels(DomainType::SrcZone).first, domains.nbits(DomainType::SrcZone) - 1);
+		EXPECT_EQ(domains.swap_src_dst(z1->make_bdd()), z3->make_bdd());
+		EXPECT_EQ(domains.get_var(DomainType::DstTcpPort) == bvec_con(16, 443), port);
+
+		domains.reset_bdd();
+	});
+	thread.join();
+}
+
+
+TEST(Domains, use) {
+	using namespace fwm;
+
+	Domains& domains = Domains::get();
+
+	// The source and destination variables are allocated together.
+	domains.use(DomainType::DstAddress6);
+	EXPECT_EQ(domains.get_var(DomainType::SrcAddress6).bitnum(), SrcAddress6Domain::nbits());
+	EXPECT_EQ(domains.get_var(DomainType::DstAddress6).bitnum(), DstAddress6Domain::nbits());
+
+	// The variable of an unused domain is allocated on demand.
+	EXPECT_EQ(domains.get_var(DomainType::User).bitnum(), domains.nbits(DomainType::User));
+}
+
+
+TEST(Domains, page_mode) {
+	using namespace fwm;
+
+	// Returns the number of ports in a set of port ranges.
+	auto count_ports = []() -> double {
+		const bvec& var = Domains::get().get_var(DomainType::DstTcpPort);
+
+		bdd ports{ bddfalse };
+		for (int port = 0; port < 4000; port += 3)
+			ports |= bvec_lte(bvec_con(16, port), var) & bvec_lte(var, bvec_con(16, port + 1));
+
+		bdd varset{ bddtrue };
+		for (int bit = 0; bit < var.bitnum(); bit++)
+			varset &= var[bit];
+
+		return bdd_satcountset(ports, varset);
+	};
+
+	const double expected = count_ports();
+	EXPECT_EQ(expected, 2668);
+
+	// The tables of a new manager are backed by huge pages when available,
+	// otherwise the allocation falls back to the standard allocator.  The
+	// mode of the main thread does not apply to the manager of a new thread.
+	const int main_mode = bdd_setpagemode(BDD_PAGES_HUGE);
+	for (const int page_mode : { BDD_PAGES_TRANSPARENT, BDD_PAGES_HUGE }) {
+		std::thread thread([page_mode, &count_ports, expected]() -> void {
+			const int old_mode = bdd_setpagemode(page_mode);
+			EXPECT_EQ(old_mode, BDD_PAGES_DEFAULT);
+			Domains::get().init_bdd(150000, 200000);
+			bdd_gbc_hook(nullptr);
+			const int node_size = bdd_getallocnum();
+
+			EXPECT_LE(bdd_getpagemode(), page_mode);
+			EXPECT_EQ(count_ports(), expected);
+
+			// The node table is copied when it grows.
+			const bvec& var = Domains::get().get_var(DomainType::DstAddress4);
+			std::vector<bdd> addresses;
+			for (uint32_t address = 0; address < 12000; address++)
+				addresses.push_back(var == bvec_con(32, address * 7919));
+			EXPECT_GT(bdd_getallocnum(), node_size);
+			EXPECT_EQ(count_ports(), expected);
+			EXPECT_EQ(addresses[1234], var == bvec_con(32, 1234 * 7919));
+
+			addresses.clear();
+			Domains::get().reset_bdd();
+			bdd_setpagemode(old_mode);
+		});
+		thread.join();
+	}
+	bdd_setpagemode(main_mode);
+}
+
+
+TEST(Domains, growth_policy) {
+	using namespace fwm;
+
+	std::thread thread([]() -> void {
+		Domains& domains = Domains::get();
+		domains.init_bdd(100000, 10000);
+
+		// Invalid settings are reported as exceptions.
+		EXPECT_THROW(domains.set_growth_policy(50000, 101, 0), std::runtime_error);
+		EXPECT_THROW(domains.set_growth_policy(50000, 20, 1), std::runtime_error);
+
+		// The node table grows up to 4 MB.
+		domains.set_growth_policy(50000, 20, 4);
+		const bvec& var = domains.get_var(DomainType::DstAddress4);
+		const bdd address = var == bvec_con(32, 1234 * 7919);
+
+		std::vector<bdd> addresses;
+		EXPECT_THROW(
+			for (uint32_t address = 0; address < 100000; address++)
+				addresses.push_back(var == bvec_con(32, address * 7919)),
+			bddnodeerror
+		);
+		EXPECT_GT(bdd_getallocnum(), 100000);
+		EXPECT_LE(bdd_getallocnum(), 4 * 1024 * 1024 / 20);
+		EXPECT_EQ(bdd_errorcond(), 0);
+
+		// The operations succeed again once nodes are released.
+		addresses.clear();
+		EXPECT_EQ(var == bvec_con(32, 1234 * 7919), address);
+		EXPECT_EQ(bdd_satcount(var == bvec_con(32, 1)), bdd_satcount(address));
+
+		domains.reset_bdd();
+	});
+	thread.join();
+}
+
+
+TEST(Domains, cache_budget) {
+	using namespace fwm;
+
+	std::thread thread([]() -> void {
+		Domains& domains = Domains::get();
+		domains.init_bdd(100000, 1000);
+		bdd_gbc_hook(nullptr);
+
+		// Invalid budgets are reported as exceptions.
+		EXPECT_THROW(domains.set_cache_budget(-1, 1000), std::runtime_error);
+		EXPECT_THROW(domains.set_cache_budget(5000, 1000), std::runtime_error);
+
+		// The caches grow while the results computed do not fit.
+		domains.set_cache_budget(1000, 50000);
+		const bvec& var = domains.get_var(DomainType::DstTcpPort);
+		bdd ports{ bddfalse };
+		for (int port = 0; port < 4000; port += 3)
+			ports |= bvec_lte(bvec_con(16, port), var) & bvec_lte(var, bvec_con(16, port + 1));
+		EXPECT_GT(bdd_getcachesize(), 1009);
+		EXPECT_LE(bdd_getcachesize(), 50021);
+
+		bdd varset{ bddtrue };
+		for (int bit = 0; bit < var.bitnum(); bit++)
+			varset &= var[bit];
+		EXPECT_EQ(bdd_satcountset(ports, varset), 2668);
+
+		// A smaller budget shrinks the caches.
+		domains.set_cache_budget(0, 2000);
+		EXPECT_LE(bdd_getcachesize(), 2003);
+
+		domains.reset_bdd();
+	});
+	thread.join();
+}
+
+
+
+TEST(Domains, cache_budget_flat_hit_rate) {
+	using namespace fwm;
+
+	std::thread thread([]() -> void {
+		Domains& domains = Domains::get();
+		domains.init_bdd(100000, 1000);
+		bdd_gbc_hook(nullptr);
+
+		// Random ranges of addresses, the results computed never fit in the
+		// caches and the hit rate levels off as the caches grow.
+		domains.set_cache_budget(1000, 50000);
+		const bvec& src = domains.get_var(DomainType::SrcAddress4);
+		const bvec& dst = domains.get_var(DomainType::DstAddress4);
+		unsigned int seed = 7;
+		auto next = [&seed]() -> unsigned int {
+			seed = seed * 1103515245 + 12345;
+			return seed >> 1;
+		};
+
+		for (int count = 0; count < 3000; count++) {
+			const bdd range = bvec_lte(bvec_con(32, next()), src) & bvec_lte(dst, bvec_con(32, next()));
+			EXPECT_NE(range, bddfalse);
+		}
+
+		// The growth that does not raise the hit rate is undone, the caches
+		// stay below the budget.
+		EXPECT_GT(bdd_getcachesize(), 1009);
+		EXPECT_LT(bdd_getcachesize(), 50021);
+
+		domains.reset_bdd();
+	});
+	thread.join();
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ostore/policygenerator.h"
+
+using namespace fos;
+
+
+// Returns the content of a file and removes the file.
+static std::string read_and_remove(const std::string& filename)
+{
+	std::ifstream file{ filename, std::ifstream::in };
+	EXPECT_TRUE(file.good()) << filename;
+
+	std::ostringstream content;
+	content << file.rdbuf();
+	file.close();
+	std::remove(filename.c_str());
+
+	return content.str();
+}
+
+
+// Generates a policy and returns the content of the generated files.
+static std::vector<std::string> generate(PolicyGenerator& generator, const std::string& prefix)
+{
+	std::vector<std::string> contents;
+	for (const std::string& filename : generator.generate(prefix).filenames()) {
+		std::string content = read_and_remove(filename);
+
+		// The script names the files of the prefix.
+		for (size_t pos = content.find(prefix); pos != std::string::npos; pos = content.find(prefix, pos))
+			content.replace(pos, prefix.size(), "<prefix>");
+
+		contents.push_back(content);
+	}
+
+	return contents;
+}
+
+
+TEST(PolicyGenerator, determinism) {
+	PolicyGeneratorConfig config;
+	config.rule_count = 300;
+	config.zone_count = 4;
+	config.ipv6_ratio = 25;
+	config.app_ratio = 30;
+	config.negate_ratio = 10;
+	config.seed = 7;
+
+	PolicyGenerator generator{ config };
+	const std::vector<std::string> expected = generate(generator, "test-generator-1");
+	ASSERT_EQ(expected.size(), 7);
+	for (const std::string& content : expected)
+		EXPECT_FALSE(content.empty());
+
+	// The same generator and another generator with the same parameters
+	// write the same files.
+	EXPECT_EQ(generate(generator, "test-generator-2"), expected);
+
+	PolicyGenerator other_generator{ config };
+	EXPECT_EQ(generate(other_generator, "test-generator-3"), expected);
+
+	// Another seed changes the policy.
+	config.seed = 8;
+	PolicyGenerator seed_generator{ config };
+	EXPECT_NE(generate(seed_generator, "test-generator-4")[5], expected[5]);
+}
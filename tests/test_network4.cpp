@@ -85,3 +85,66 @@ TEST(Network4, dst_address_group) {
 	ASSERT_TRUE(network.get_dst_address("a2")->is_subset(*network.get_dst_address_group("g1")));
 	ASSERT_TRUE(network.get_dst_address_group("g1")->contains(network.get_dst_address("a3")));
 }
+
+
+TEST(Network4, memoized_bdd) {
+	using namespace fwm;
+
+	ModelConfig model_config;
+	Network network(model_config);
+
+	const SrcAddress* a1 = network.register_src_address("a1", "10.0.4.0/30");
+	const SrcAddress* a2 = network.register_src_address("a2", "10.0.5.0/30");
+
+	// The bdd of a group is built again when a member is added.
+	SrcAddressGroup group{ "g1", a1 };
+	ASSERT_EQ(group.make_bdd(), a1->make_bdd());
+	group.add_member(a2);
+	ASSERT_EQ(group.make_bdd(), a1->make_bdd() | a2->make_bdd());
+
+	// The bdd of an application is built again when the model options change.
+	const Application* app = network.register_application("app1", { "tcp/80" }, false);
+	ASSERT_NE(app->make_bdd(), bddtrue);
+	network.model_options.remove(ModelOption::Application);
+	network.clear_rule_bdds();
+	ASSERT_EQ(app->make_bdd(), bddtrue);
+	network.model_options.add(ModelOption::Application);
+	network.clear_rule_bdds();
+	ASSERT_NE(app->make_bdd(), bddtrue);
+}
+
+
+TEST(Network4, reserved_ids) {
+	using namespace fwm;
+
+	ModelConfig model_config;
+	Network network(model_config);
+
+	// The users of g1 are registered in their first-seen order, the
+	// users of g2 have ids reserved in the order of the group.
+	std::vector<std::string> g1_members;
+	std::vector<std::string> g2_members;
+	for (int i = 0; i < 64; i++) {
+		g1_members.push_back("g1-user" + std::to_string(i));
+		g2_members.push_back("g2-user" + std::to_string(i));
+	}
+
+	int others = 0;
+	for (int i = 0; i < 64; i++) {
+		network.register_user(g1_members[i]);
+		for (int j = 0; j < (i * 7) % 5; j++)
+			network.register_user("other" + std::to_string(others++));
+	}
+
+	for (const std::string& member : g2_members)
+		network.reserve_user_id(member);
+	for (int i = 63; i >= 0; i--)
+		network.register_user(g2_members[i]);
+
+	const UserGroup* g1 = network.register_user_group("g1", g1_members);
+	const UserGroup* g2 = network.register_user_group("g2", g2_members);
+
+	// Contiguous ids are encoded by a few prefixes.
+	EXPECT_LT(bdd_nodecount(g2->make_bdd()), bdd_nodecount(g1->make_bdd()));
+	EXPECT_EQ(g2->make_bdd() & g1->make_bdd(), bddfalse);
+}
@@ -2,6 +2,9 @@
 #include <memory>
 
 #include "buddy/bvec.h"
+#include "model/domains.h"
+#include "model/intervalset.h"
+#include "model/mvalue.h"
 #include "model/range.h"
 #include "model/rangeimpl.h"
 
@@ -140,3 +143,124 @@ TEST(Test_Range, singleton) {
 		EXPECT_TRUE(range->is_power_of_2());
 	}
 }
+
+
+TEST(Test_Range, prefix_bdd) {
+	using namespace fwm;
+
+	// Returns the bdd of a range built with the bvec comparators.
+	auto comparator_bdd = [](DomainType dt, const Range& range) -> bdd {
+		const bvec& var = Domains::get()[dt].var();
+		return bvec_lte(range.lbound(), var) & bvec_lte(var, range.ubound());
+	};
+
+	const std::pair<uint16_t, uint16_t> ports[] = {
+		{ 0, 0 }, { 80, 80 }, { 1, 65534 }, { 1024, 65535 }, { 0, 1023 }, { 1000, 2000 }, { 32767, 32768 }
+	};
+	for (const auto& port : ports) {
+		const Mvalue value{ DomainType::DstTcpPort, new Range16(16, port.first, port.second) };
+		EXPECT_EQ(value.make_bdd(), comparator_bdd(DomainType::DstTcpPort, value.range()));
+	}
+
+	const std::pair<uint32_t, uint32_t> addresses4[] = {
+		{ 0x0A000000, 0x0AFFFFFF }, { 0x0A000001, 0x0A0000FE }, { 0xC0A80101, 0xC0A80101 }, { 1, UINT32_MAX - 1 }
+	};
+	for (const auto& address : addresses4) {
+		const Mvalue value{ DomainType::SrcAddress4, new Range32(32, address.first, address.second) };
+		EXPECT_EQ(value.make_bdd(), comparator_bdd(DomainType::SrcAddress4, value.range()));
+	}
+
+	const uint128_t prefix{ 0x20010db800000000, 0 };
+	const std::pair<uint128_t, uint128_t> addresses6[] = {
+		{ prefix, prefix | uint128_t(0, UINT64_MAX) },
+		{ prefix + 1, prefix + 1 },
+		{ prefix + 3, prefix + (uint128_t(1) << 70) + 5 },
+		{ 1, ~uint128_t(0) - 1 }
+	};
+	for (const auto& address : addresses6) {
+		const Mvalue value{ DomainType::DstAddress6, new Range128(128, address.first, address.second) };
+		EXPECT_EQ(value.make_bdd(), comparator_bdd(DomainType::DstAddress6, value.range()));
+	}
+
+	// Ranges are compared by their bounds.
+	EXPECT_TRUE(Range32(32, 1, 10) == Range32(32, 1, 10));
+	EXPECT_FALSE(Range32(32, 1, 10) == Range32(32, 1, 11));
+	EXPECT_FALSE(Range32(32, 1, 10) == Range16(16, 1, 10));
+}
+
+
+TEST(Test_Range, interval_set) {
+	using namespace fwm;
+
+	IntervalSet set;
+	EXPECT_TRUE(set.empty());
+
+	set.add(20, 30);
+	set.add(0, 4);
+	set.add(5, 9);
+	set.add(25, 40);
+	set.add(100, 100);
+	set.add(22, 23);
+	set.normalize();
+
+	// [0, 4] and [5, 9] are adjacent, [20, 30], [22, 23] and [25, 40] overlap.
+	ASSERT_EQ(set.intervals().size(), 3);
+	EXPECT_TRUE(set.intervals()[0].lower == 0 && set.intervals()[0].upper == 9);
+	EXPECT_TRUE(set.intervals()[1].lower == 20 && set.intervals()[1].upper == 40);
+	EXPECT_TRUE(set.intervals()[2].lower == 100 && set.intervals()[2].upper == 100);
+
+	EXPECT_TRUE(set.contains(0));
+	EXPECT_TRUE(set.contains(9));
+	EXPECT_FALSE(set.contains(10));
+	EXPECT_TRUE(set.contains(100));
+	EXPECT_FALSE(set.contains(101));
+	EXPECT_TRUE(set.contains(21, 39));
+	EXPECT_FALSE(set.contains(5, 20));
+
+	// An interval ending at the maximum value absorbs the following intervals.
+	IntervalSet full;
+	full.add(~uint128_t(0) - 10, ~uint128_t(0));
+	full.add(~uint128_t(0) - 2, ~uint128_t(0) - 1);
+	full.add(0, 0);
+	full.normalize();
+	ASSERT_EQ(full.intervals().size(), 2);
+	EXPECT_TRUE(full.contains(~uint128_t(0)));
+
+	const bvec& var = Domains::get()[DomainType::DstTcpPort].var();
+	const bdd expected = (bvec_lte(var, bvec_con(16, 9))) | (bvec_lte(bvec_con(16, 20), var) & bvec_lte(var, bvec_con(16, 40))) | (var == bvec_con(16, 100));
+	EXPECT_EQ(set.make_bdd(var), expected);
+}
+
+
+TEST(Test_Range, relation) {
+	using namespace fwm;
+
+	// Returns the relationship between two bdds computed with the apply operators.
+	auto apply_relation = [](const bdd& l, const bdd& r) -> int {
+		return ((l & !r) != bddfalse ? BDD_REL_ONLY_LEFT : 0) |
+			((r & !l) != bddfalse ? BDD_REL_ONLY_RIGHT : 0) |
+			((l & r) != bddfalse ? BDD_REL_BOTH : 0);
+	};
+
+	const bvec& tcp = Domains::get()[DomainType::DstTcpPort].var();
+	const bvec& udp = Domains::get()[DomainType::DstUdpPort].var();
+
+	std::vector<bdd> bdds{ bddfalse, bddtrue };
+	const std::pair<uint16_t, uint16_t> ports[] = {
+		{ 0, 0 }, { 80, 80 }, { 0, 1023 }, { 1000, 2000 }, { 1024, 65535 }, { 2001, 3000 }
+	};
+	for (const auto& port : ports) {
+		bdds.push_back(make_range_bdd(tcp, port.first, port.second));
+		bdds.push_back(make_range_bdd(udp, port.first, port.second));
+		bdds.push_back(bdds[bdds.size() - 2] & bdds[bdds.size() - 1]);
+	}
+
+	for (const bdd& l : bdds) {
+		for (const bdd& r : bdds) {
+			const int relation = apply_relation(l, r);
+			EXPECT_EQ(bdd_relation(l, r), relation);
+			EXPECT_EQ(bdd_subset(l, r), (relation & BDD_REL_ONLY_LEFT) == 0 ? 1 : 0);
+			EXPECT_EQ(bdd_disjoint(l, r), (relation & BDD_REL_BOTH) == 0 ? 1 : 0);
+		}
+	}
+}